@@ -74,7 +74,7 @@ awesome_atexit(bool restart)
 {
     lua_State *L = globalconf_get_lua_State();
     lua_pushboolean(L, restart);
-    signal_object_emit(L, &global_signals, "exit", 1);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("exit"), 1);
 
     /* Move clients where we want them to be and keep the stacking order intact */
     foreach(c, globalconf.stack)
@@ -143,10 +143,19 @@ restore_client_order(xcb_get_property_cookie_t prop_cookie)
                 client_idx++;
             }
 
-    luaA_class_emit_signal(globalconf_get_lua_State(), &client_class, "list", 0);
+    luaA_class_emit_signal(globalconf_get_lua_State(), &client_class, SIGNAL_ID("list"), 0);
     p_delete(&reply);
 }
 
+/** A window found by scan() that is going to be managed */
+typedef struct
+{
+    xcb_window_t window;
+    xcb_get_window_attributes_reply_t *attr_r;
+    xcb_get_geometry_reply_t *geom_r;
+    client_manage_request_t req;
+} scan_window_t;
+
 /** Scan X to find windows to manage.
  */
 static void
@@ -190,6 +199,11 @@ scan(xcb_query_tree_cookie_t tree_c)
         geom_wins[i] = xcb_get_geometry_unchecked(globalconf.connection, wins[i]);
     }
 
+    /* Windows to manage, with all the requests for them sent before any of
+     * the replies is waited for */
+    int manage_len = 0;
+    scan_window_t *manage = p_new(scan_window_t, tree_c_len);
+
     for(i = 0; i < tree_c_len; i++)
     {
         attr_r = xcb_get_window_attributes_reply(globalconf.connection,
@@ -208,12 +222,28 @@ scan(xcb_query_tree_cookie_t tree_c)
             continue;
         }
 
-        client_manage(wins[i], geom_r, attr_r);
+        manage[manage_len].window = wins[i];
+        manage[manage_len].attr_r = attr_r;
+        manage[manage_len].geom_r = geom_r;
+        client_manage_prefetch(wins[i], &manage[manage_len].req);
+        manage_len++;
+    }
+
+    for(i = 0; i < manage_len; i++)
+        client_manage_prefetch_startup_id(&manage[i].req);
 
-        p_delete(&attr_r);
-        p_delete(&geom_r);
+    for(i = 0; i < manage_len; i++)
+    {
+        client_manage(manage[i].window, manage[i].geom_r, manage[i].attr_r,
+                      &manage[i].req);
+
+        p_delete(&manage[i].attr_r);
+        p_delete(&manage[i].geom_r);
     }
 
+    globalconf.stats.startup_windows += manage_len;
+
+    p_delete(&manage);
     p_delete(&tree_r);
 
     restore_client_order(prop_cookie);
@@ -498,6 +528,7 @@ main(int argc, char **argv)
     globalconf.exit_code = EXIT_SUCCESS;
     buffer_init(&globalconf.startup_errors);
     string_array_init(&searchpath);
+    window_index_init();
 
     /* save argv */
     for(i = 0; i < argc; i++)
@@ -778,7 +809,9 @@ main(int argc, char **argv)
     xdgWipeHandle(&xdg);
 
     /* scan existing windows */
+    gint64 scan_start = g_get_monotonic_time();
     scan(tree_c);
+    globalconf.stats.startup_scan_usec = g_get_monotonic_time() - scan_start;
 
     luaA_emit_startup();
 
@@ -22,49 +22,92 @@
 #include "banning.h"
 #include "globalconf.h"
 #include "objects/client.h"
+#include "objects/tag.h"
 
-/** Reban windows following current selected tags.
+/** Reban a client whose visibility may have changed.
+ * \param c The client.
  */
 void
-banning_need_update(void)
+banning_client_need_update(client_t *c)
 {
-    /* We update the complete banning only once per main loop to avoid
-     * excessive updates...  */
-    globalconf.need_lazy_banning = true;
+    /* If the client will be banned in our next update we unfocus it now. */
+    if(!client_isvisible(c))
+        client_ban_unfocus(c);
 
-    /* But if a client will be banned in our next update we unfocus it now. */
-    foreach(_c, globalconf.clients)
-    {
-        client_t *c = *_c;
+    /* The banning itself is only updated once per main loop to avoid
+     * excessive updates. */
+    if(c->banning_need_update)
+        return;
+    c->banning_need_update = true;
+    client_array_append(&globalconf.refresh.banning, c);
+}
+
+/** Reban the clients of a tag whose selection changed.
+ * \param t The tag.
+ */
+void
+banning_tag_need_update(tag_t *t)
+{
+    foreach(c, t->clients)
+        banning_client_need_update(*c);
+}
 
-        if(!client_isvisible(c))
-            client_ban_unfocus(c);
-    }
+/** Drop a client that is going away from the banning queue.
+ * \param c The client.
+ */
+void
+banning_client_forget(client_t *c)
+{
+    if(!c->banning_need_update)
+        return;
+    c->banning_need_update = false;
+    foreach(elem, globalconf.refresh.banning)
+        if(*elem == c)
+        {
+            client_array_remove(&globalconf.refresh.banning, elem);
+            break;
+        }
 }
 
-/** Check all clients if they need to rebanned
+/** Check the clients whose visibility may have changed if they need to be
+ * rebanned
  */
 void
 banning_refresh(void)
 {
-    if (!globalconf.need_lazy_banning)
+    /* Spare array for the queue, to avoid reallocating it on every refresh */
+    static client_array_t spare;
+    client_array_t queue = globalconf.refresh.banning;
+
+    if (!queue.len)
         return;
 
-    globalconf.need_lazy_banning = false;
+    /* Unbanning can change the minimized and hidden state, which queues the
+     * client again. Take the queue so that this goes to the next refresh. */
+    globalconf.refresh.banning = spare;
+    foreach(c, queue)
+        (*c)->banning_need_update = false;
 
     client_ignore_enterleave_events();
 
-    foreach(c, globalconf.clients)
+    foreach(c, queue)
         if(client_isvisible(*c))
             client_unban(*c);
 
     /* Some people disliked the short flicker of background, so we first unban everything.
      * Afterwards we ban everything we don't want. This should avoid that. */
-    foreach(c, globalconf.clients)
+    foreach(c, queue)
         if(!client_isvisible(*c))
             client_ban(*c);
 
     client_restore_enterleave_events();
+
+    globalconf.stats.banning_refresh++;
+    globalconf.stats.banning_clients += queue.len;
+    globalconf.stats.banning_last_clients = queue.len;
+
+    queue.len = 0;
+    spare = queue;
 }
 
 // vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
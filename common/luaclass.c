@@ -147,6 +147,14 @@ lua_class_property_cmp(const void *a, const void *b)
 
 BARRAY_FUNCS(lua_class_property_t, lua_class_property, DO_NOTHING, lua_class_property_cmp)
 
+/** Incremented whenever a class or a property is added, which makes all
+ * lookup tables outdated */
+static unsigned int lua_class_generation;
+
+/** Markers for the special 'valid' and 'data' properties in lookup tables */
+static lua_class_property_t lua_class_property_valid = { .name = "valid" };
+static lua_class_property_t lua_class_property_data = { .name = "data" };
+
 void
 luaA_class_add_property(lua_class_t *lua_class,
                         const char *name,
@@ -154,6 +162,7 @@ luaA_class_add_property(lua_class_t *lua_class,
                         lua_class_propfunc_t cb_index,
                         lua_class_propfunc_t cb_newindex)
 {
+    lua_class_generation++;
     lua_class_property_array_insert(&lua_class->properties, (lua_class_property_t)
                                     {
                                         .name = name,
@@ -284,6 +293,8 @@ luaA_class_setup(lua_State *L, lua_class_t *class,
     class->instances = 0;
     class->index_miss_handler = LUA_REFNIL;
     class->newindex_miss_handler = LUA_REFNIL;
+    class->lookup_table = LUA_REFNIL;
+    lua_class_generation++;
 
     lua_class_array_append(&luaA_classes, class);
 }
@@ -292,33 +303,110 @@ void
 luaA_class_connect_signal(lua_State *L, lua_class_t *lua_class, const char *name, lua_CFunction fn)
 {
     lua_pushcfunction(L, fn);
-    luaA_class_connect_signal_from_stack(L, lua_class, name, -1);
+    luaA_class_connect_signal_from_stack(L, lua_class, signal_intern(name), -1);
 }
 
 void
 luaA_class_connect_signal_from_stack(lua_State *L, lua_class_t *lua_class,
-                                     const char *name, int ud)
+                                     signal_id_t id, int ud)
 {
     luaA_checkfunction(L, ud);
-    signal_connect(&lua_class->signals, name, luaA_object_ref(L, ud));
+    signal_connect(&lua_class->signals, id, luaA_object_ref(L, ud));
 }
 
 void
 luaA_class_disconnect_signal_from_stack(lua_State *L, lua_class_t *lua_class,
-                                        const char *name, int ud)
+                                        signal_id_t id, int ud)
 {
     luaA_checkfunction(L, ud);
     void *ref = (void *) lua_topointer(L, ud);
-    if (signal_disconnect(&lua_class->signals, name, ref))
+    if (signal_disconnect(&lua_class->signals, id, ref))
         luaA_object_unref(L, (void *) ref);
     lua_remove(L, ud);
 }
 
 void
 luaA_class_emit_signal(lua_State *L, lua_class_t *lua_class,
-                       const char *name, int nargs)
+                       signal_id_t id, int nargs)
 {
-    signal_object_emit(L, &lua_class->signals, name, nargs);
+    signal_object_emit(L, &lua_class->signals, id, nargs);
+}
+
+/** Key of the registry table that caches the identifiers of signal names
+ * coming from Lua. Lua strings are interned, so looking one up in a table
+ * only compares pointers. */
+static char signal_ids_key;
+
+/** Get the signal identifier for a string argument.
+ * \param L The Lua VM state.
+ * \param idx The index of the signal name on the stack.
+ * \param intern Whether to intern names that were never seen before.
+ * \return The signal identifier, or 0 for an unknown name if intern is false.
+ */
+static signal_id_t
+luaA_getsignal(lua_State *L, int idx, bool intern)
+{
+    const char *name = luaL_checkstring(L, idx);
+    signal_id_t id;
+
+    idx = luaA_absindex(L, idx);
+
+    lua_pushlightuserdata(L, &signal_ids_key);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    if(lua_isnil(L, -1))
+    {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushlightuserdata(L, &signal_ids_key);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+
+    lua_pushvalue(L, idx);
+    lua_rawget(L, -2);
+    id = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+
+    if(!id)
+    {
+        id = intern ? signal_intern(name) : signal_lookup(name);
+        /* Only remember known names, so that unknown ones cannot grow the
+         * table */
+        if(id)
+        {
+            lua_pushvalue(L, idx);
+            lua_pushinteger(L, id);
+            lua_rawset(L, -3);
+        }
+    }
+
+    lua_pop(L, 1);
+    return id;
+}
+
+/** Get the signal identifier for a string argument, interning the name if
+ * needed. Use this when connecting to a signal.
+ * \param L The Lua VM state.
+ * \param idx The index of the signal name on the stack.
+ * \return The signal identifier.
+ */
+signal_id_t
+luaA_checksignal(lua_State *L, int idx)
+{
+    return luaA_getsignal(L, idx, true);
+}
+
+/** Get the signal identifier for a string argument without interning it.
+ * Nobody can be connected to a name that was never interned, so emitting or
+ * disconnecting it does nothing. Use this for these operations.
+ * \param L The Lua VM state.
+ * \param idx The index of the signal name on the stack.
+ * \return The signal identifier, or 0 if nothing ever connected to it.
+ */
+signal_id_t
+luaA_lookupsignal(lua_State *L, int idx)
+{
+    return luaA_getsignal(L, idx, false);
 }
 
 /** Try to use the metatable of an object.
@@ -389,6 +477,116 @@ luaA_class_property_get(lua_State *L, lua_class_t *lua_class, int fieldidx)
     return NULL;
 }
 
+/** Push the lookup table of a class.
+ * This table maps everything that can be indexed on an object of this class to
+ * either the value from the metatable of the class or of one of its parents,
+ * or to a lightuserdata pointing to the lua_class_property_t to use. It is
+ * flattened across inheritance, so that a lookup is a single probe keyed by
+ * the interned Lua string. Entries have the same precedence as before: the
+ * metatables first, then the 'valid' and 'data' special properties, then the
+ * class properties, with children overriding their parents.
+ * \param L The Lua VM state.
+ * \param lua_class The Lua class.
+ */
+static void
+luaA_class_push_lookup(lua_State *L, lua_class_t *lua_class)
+{
+    if(lua_class->lookup_table != LUA_REFNIL
+       && lua_class->lookup_generation == lua_class_generation)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, lua_class->lookup_table);
+        return;
+    }
+
+    luaL_unref(L, LUA_REGISTRYINDEX, lua_class->lookup_table);
+
+    int depth = 0;
+    for(lua_class_t *class = lua_class; class; class = class->parent)
+        depth++;
+    lua_class_t **chain = p_alloca(lua_class_t *, depth);
+    depth = 0;
+    for(lua_class_t *class = lua_class; class; class = class->parent)
+        chain[depth++] = class;
+
+    lua_newtable(L);
+
+    /* Go from the root class to this one, so that children win */
+    for(int i = depth - 1; i >= 0; i--)
+        foreach(prop, chain[i]->properties)
+        {
+            lua_pushstring(L, prop->name);
+            lua_pushlightuserdata(L, prop);
+            lua_rawset(L, -3);
+        }
+
+    lua_pushliteral(L, "valid");
+    lua_pushlightuserdata(L, &lua_class_property_valid);
+    lua_rawset(L, -3);
+    lua_pushliteral(L, "data");
+    lua_pushlightuserdata(L, &lua_class_property_data);
+    lua_rawset(L, -3);
+
+    for(int i = depth - 1; i >= 0; i--)
+    {
+        /* Get the metatable of the class from the registry */
+        lua_pushlightuserdata(L, chain[i]);
+        lua_rawget(L, LUA_REGISTRYINDEX);
+        lua_pushnil(L);
+        while(lua_next(L, -2))
+        {
+            /* Copy the key and set key = value in the lookup table */
+            lua_pushvalue(L, -2);
+            lua_insert(L, -2);
+            lua_rawset(L, -5);
+        }
+        lua_pop(L, 1);
+    }
+
+    lua_pushvalue(L, -1);
+    lua_class->lookup_table = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_class->lookup_generation = lua_class_generation;
+}
+
+/** Look up a field of an object of a class.
+ * \param L The Lua VM state.
+ * \param lua_class The Lua class.
+ * \param fieldidx The index of the field name.
+ * \param prop Where to store the property that was found, if any.
+ * \return True if a value from the metatable was pushed on the stack.
+ */
+static bool
+luaA_class_lookup(lua_State *L, lua_class_t *lua_class, int fieldidx,
+                  lua_class_property_t **prop)
+{
+    fieldidx = luaA_absindex(L, fieldidx);
+
+    /* Properties are only ever found by name. This also converts numbers to
+     * strings, like luaL_checkstring() always did here. */
+    if(lua_type(L, fieldidx) != LUA_TSTRING)
+        luaL_checkstring(L, fieldidx);
+
+    luaA_class_push_lookup(L, lua_class);
+    lua_pushvalue(L, fieldidx);
+    lua_rawget(L, -2);
+    lua_remove(L, -2);
+
+    if(lua_islightuserdata(L, -1))
+    {
+        *prop = lua_touserdata(L, -1);
+        lua_pop(L, 1);
+        return false;
+    }
+
+    *prop = NULL;
+    if(lua_isnil(L, -1))
+    {
+        lua_pop(L, 1);
+        return false;
+    }
+
+    return true;
+}
+
 /** Call a registered function.
  * \param L The Lua VM state.
  * \param handler The function to call.
@@ -430,16 +628,16 @@ int luaA_class_call_handler(lua_State *L, int handler)
 int
 luaA_class_index(lua_State *L)
 {
-    /* Try to use metatable first. */
-    if(luaA_usemetatable(L, 1, 2))
-        return 1;
-
     lua_class_t *class = luaA_class_get(L, 1);
+    lua_class_property_t *prop;
+
+    /* Methods from the metatables win over properties */
+    if(luaA_class_lookup(L, class, 2, &prop))
+        return 1;
 
     /* Is this the special 'valid' property? This is the only property
      * accessible for invalid objects and thus needs special handling. */
-    const char *attr = luaL_checkstring(L, 2);
-    if (A_STREQ(attr, "valid"))
+    if (prop == &lua_class_property_valid)
     {
         void *p = luaA_toudata(L, 1, class);
         if (class->checker)
@@ -449,12 +647,10 @@ luaA_class_index(lua_State *L)
         return 1;
     }
 
-    lua_class_property_t *prop = luaA_class_property_get(L, class, 2);
-
     /* Is this the special 'data' property? This is available on all objects and
      * thus not implemented as a lua_class_property_t.
      */
-    if (A_STREQ(attr, "data"))
+    if (prop == &lua_class_property_data)
     {
         luaA_checkudata(L, 1, class);
         luaA_getuservalue(L, 1);
@@ -486,13 +682,16 @@ luaA_class_index(lua_State *L)
 int
 luaA_class_newindex(lua_State *L)
 {
+    lua_class_t *class = luaA_class_get(L, 1);
+    lua_class_property_t *prop;
+
     /* Try to use metatable first. */
-    if(luaA_usemetatable(L, 1, 2))
+    if(luaA_class_lookup(L, class, 2, &prop))
         return 1;
 
-    lua_class_t *class = luaA_class_get(L, 1);
-
-    lua_class_property_t *prop = luaA_class_property_get(L, class, 2);
+    /* 'valid' and 'data' can not be set */
+    if(prop == &lua_class_property_valid || prop == &lua_class_property_data)
+        prop = NULL;
 
     /* Property does exist and has a newindex callback */
     if(prop)
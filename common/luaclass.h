@@ -32,7 +32,8 @@ typedef struct lua_class_property lua_class_property_t;
 ARRAY_TYPE(lua_class_property_t, lua_class_property)
 
 #define LUA_OBJECT_HEADER \
-        signal_array_t signals;
+        signal_array_t signals; \
+        unsigned int refcount;
 
 /** Generic type for all objects.
  * All Lua objects can be casted to this type.
@@ -78,15 +79,22 @@ struct lua_class_t
     int index_miss_handler;
     /** Function to call on newindex misses */
     int newindex_miss_handler;
+    /** Reference to the table used by luaA_class_index() and
+     * luaA_class_newindex(), see luaA_class_push_lookup() */
+    int lookup_table;
+    /** Class generation the lookup table was built for */
+    unsigned int lookup_generation;
 };
 
 const char * luaA_typename(lua_State *, int);
 lua_class_t * luaA_class_get(lua_State *, int);
 
 void luaA_class_connect_signal(lua_State *, lua_class_t *, const char *, lua_CFunction);
-void luaA_class_connect_signal_from_stack(lua_State *, lua_class_t *, const char *, int);
-void luaA_class_disconnect_signal_from_stack(lua_State *, lua_class_t *, const char *, int);
-void luaA_class_emit_signal(lua_State *, lua_class_t *, const char *, int);
+void luaA_class_connect_signal_from_stack(lua_State *, lua_class_t *, signal_id_t, int);
+void luaA_class_disconnect_signal_from_stack(lua_State *, lua_class_t *, signal_id_t, int);
+void luaA_class_emit_signal(lua_State *, lua_class_t *, signal_id_t, int);
+signal_id_t luaA_checksignal(lua_State *, int);
+signal_id_t luaA_lookupsignal(lua_State *, int);
 
 void luaA_openlib(lua_State *, const char *, const struct luaL_Reg[], const struct luaL_Reg[]);
 void luaA_class_setup(lua_State *, lua_class_t *, const char *, lua_class_t *,
@@ -131,7 +139,7 @@ luaA_checkudataornil(lua_State *L, int udx, lua_class_t *class)
     luaA_##prefix##_class_connect_signal(lua_State *L)                         \
     {                                                                          \
         luaA_class_connect_signal_from_stack(L, &(lua_class),                  \
-                                             luaL_checkstring(L, 1), 2);       \
+                                             luaA_checksignal(L, 1), 2);       \
         return 0;                                                              \
     }                                                                          \
                                                                                \
@@ -139,15 +147,16 @@ luaA_checkudataornil(lua_State *L, int udx, lua_class_t *class)
     luaA_##prefix##_class_disconnect_signal(lua_State *L)                      \
     {                                                                          \
         luaA_class_disconnect_signal_from_stack(L, &(lua_class),               \
-                                                luaL_checkstring(L, 1), 2);    \
+                                                luaA_lookupsignal(L, 1), 2);   \
         return 0;                                                              \
     }                                                                          \
                                                                                \
     static inline int                                                          \
     luaA_##prefix##_class_emit_signal(lua_State *L)                            \
     {                                                                          \
-        luaA_class_emit_signal(L, &(lua_class), luaL_checkstring(L, 1),        \
-                               lua_gettop(L) - 1);                             \
+        signal_id_t id = luaA_lookupsignal(L, 1);                              \
+        if(id)                                                                 \
+            luaA_class_emit_signal(L, &(lua_class), id, lua_gettop(L) - 1);    \
         return 0;                                                              \
     }                                                                          \
                                                                                \
@@ -32,6 +32,27 @@ void luaA_checktable(lua_State *L, int idx)
         luaA_typerror(L, idx, "table");
 }
 
+/** Key of the registry entry holding the error handler for Lua calls */
+static char error_handler_key;
+
+/** Push the error handler for Lua calls. It is only created once, so that
+ * calling a Lua function does not allocate a new closure every time.
+ * \param L The Lua VM state.
+ */
+void luaA_pusherrorhandler(lua_State *L)
+{
+    lua_pushlightuserdata(L, &error_handler_key);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    if(lua_isnil(L, -1))
+    {
+        lua_pop(L, 1);
+        lua_pushcfunction(L, luaA_dofunction_error);
+        lua_pushlightuserdata(L, &error_handler_key);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+}
+
 void luaA_dumpstack(lua_State *L)
 {
     fprintf(stderr, "-------- Lua stack dump ---------\n");
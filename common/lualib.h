@@ -56,6 +56,29 @@ luaA_dofunction_error(lua_State *L)
     return 0;
 }
 
+void luaA_pusherrorhandler(lua_State *);
+
+/** Execute a Lua function with an error handler that is already on the stack.
+ * \param L The Lua stack.
+ * \param nargs The number of arguments, which are above the function.
+ * \param nret The number of returned value from the Lua function.
+ * \param errfunc The stack index of the error handler, see
+ * luaA_pusherrorhandler().
+ * \return True on no error, false otherwise.
+ */
+static inline bool
+luaA_pcall(lua_State *L, int nargs, int nret, int errfunc)
+{
+    if(lua_pcall(L, nargs, nret, errfunc))
+    {
+        warn("%s", lua_tostring(L, -1));
+        /* Remove error string */
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
 /** Execute an Lua function on top of the stack.
  * \param L The Lua stack.
  * \param nargs The number of arguments for the Lua function.
@@ -68,7 +91,7 @@ luaA_dofunction(lua_State *L, int nargs, int nret)
     /* Move function before arguments */
     lua_insert(L, - nargs - 1);
     /* Push error handling function */
-    lua_pushcfunction(L, luaA_dofunction_error);
+    luaA_pusherrorhandler(L);
     /* Move error handling function before args and function */
     lua_insert(L, - nargs - 2);
     int error_func_pos = lua_gettop(L) - nargs - 1;
@@ -159,6 +159,18 @@ luaA_object_decref(lua_State *L, int tud, const void *pointer)
     }
 }
 
+/** Report an unbalanced luaA_object_unref_class().
+ * \param pointer The object pointer.
+ */
+void
+luaA_object_unref_class_warn(const void *pointer)
+{
+    buffer_t buf;
+    backtrace_get(&buf);
+    warn("BUG: Reference not found: %p\n%s", pointer, buf.s);
+    buffer_wipe(&buf);
+}
+
 int
 luaA_settype(lua_State *L, lua_class_t *lua_class)
 {
@@ -178,7 +190,7 @@ luaA_object_connect_signal(lua_State *L, int oud,
                            const char *name, lua_CFunction fn)
 {
     lua_pushcfunction(L, fn);
-    luaA_object_connect_signal_from_stack(L, oud, name, -1);
+    luaA_object_connect_signal_from_stack(L, oud, signal_intern(name), -1);
 }
 
 /** Remove a signal.
@@ -191,68 +203,69 @@ luaA_object_disconnect_signal(lua_State *L, int oud,
                               const char *name, lua_CFunction fn)
 {
     lua_pushcfunction(L, fn);
-    luaA_object_disconnect_signal_from_stack(L, oud, name, -1);
+    luaA_object_disconnect_signal_from_stack(L, oud, signal_lookup(name), -1);
 }
 
 /** Add a signal to an object.
  * \param L The Lua VM state.
  * \param oud The object index on the stack.
- * \param name The name of the signal.
+ * \param id The signal identifier.
  * \param ud The index of function to call when signal is emitted.
  */
 void
 luaA_object_connect_signal_from_stack(lua_State *L, int oud,
-                                      const char *name, int ud)
+                                      signal_id_t id, int ud)
 {
     luaA_checkfunction(L, ud);
     lua_object_t *obj = lua_touserdata(L, oud);
-    signal_connect(&obj->signals, name, luaA_object_ref_item(L, oud, ud));
+    signal_connect(&obj->signals, id, luaA_object_ref_item(L, oud, ud));
 }
 
 /** Remove a signal to an object.
  * \param L The Lua VM state.
  * \param oud The object index on the stack.
- * \param name The name of the signal.
+ * \param id The signal identifier.
  * \param ud The index of function to call when signal is emitted.
  */
 void
 luaA_object_disconnect_signal_from_stack(lua_State *L, int oud,
-                                         const char *name, int ud)
+                                         signal_id_t id, int ud)
 {
     luaA_checkfunction(L, ud);
     lua_object_t *obj = lua_touserdata(L, oud);
     void *ref = (void *) lua_topointer(L, ud);
-    if (signal_disconnect(&obj->signals, name, ref))
+    if (signal_disconnect(&obj->signals, id, ref))
         luaA_object_unref_item(L, oud, ref);
     lua_remove(L, ud);
 }
 
 void
-signal_object_emit(lua_State *L, signal_array_t *arr, const char *name, int nargs)
+signal_object_emit(lua_State *L, signal_array_t *arr, signal_id_t id, int nargs)
 {
-    signal_t *sigfound = signal_array_getbyid(arr,
-                                              a_strhash((const unsigned char *) name));
+    signal_t *sigfound = signal_array_getbyid(arr, id);
 
     if(sigfound)
     {
         int nbfunc = sigfound->sigfuncs.len;
-        luaL_checkstack(L, nbfunc + nargs + 1, "too much signal");
+        int args = lua_gettop(L) - nargs + 1;
+        luaL_checkstack(L, nbfunc + nargs + 2, "too much signal");
+        luaA_pusherrorhandler(L);
+        int errfunc = lua_gettop(L);
         /* Push all functions and then execute, because this list can change
          * while executing funcs. */
         foreach(func, sigfound->sigfuncs)
             luaA_object_push(L, *func);
 
-        for(int i = 0; i < nbfunc; i++)
+        for(int i = 1; i <= nbfunc; i++)
         {
-            /* push all args */
+            lua_pushvalue(L, errfunc + i);
             for(int j = 0; j < nargs; j++)
-                lua_pushvalue(L, - nargs - nbfunc + i);
-            /* push first function */
-            lua_pushvalue(L, - nargs - nbfunc + i);
-            /* remove this first function */
-            lua_remove(L, - nargs - nbfunc - 1 + i);
-            luaA_dofunction(L, nargs, 0);
+                lua_pushvalue(L, args + j);
+            luaA_pcall(L, nargs, 0, errfunc);
         }
+
+        /* remove functions and error handler */
+        lua_pop(L, nbfunc + 1);
     }
 
     /* remove args */
@@ -266,69 +279,82 @@ signal_object_emit(lua_State *L, signal_array_t *arr, const char *name, int narg
  */
 void
 luaA_object_emit_signal(lua_State *L, int oud,
-                        const char *name, int nargs)
+                        signal_id_t id, int nargs)
 {
     int oud_abs = luaA_absindex(L, oud);
     lua_class_t *lua_class = luaA_class_get(L, oud);
     lua_object_t *obj = luaA_toudata(L, oud, lua_class);
     if(!obj) {
-        luaA_warn(L, "Trying to emit signal '%s' on non-object", name);
+        luaA_warn(L, "Trying to emit signal '%s' on non-object", signal_name(id));
         return;
     }
     else if(lua_class->checker && !lua_class->checker(obj)) {
-        luaA_warn(L, "Trying to emit signal '%s' on invalid object", name);
+        luaA_warn(L, "Trying to emit signal '%s' on invalid object", signal_name(id));
         return;
     }
-    signal_t *sigfound = signal_array_getbyid(&obj->signals,
-                                              a_strhash((const unsigned char *) name));
+
+    signal_t *sigfound = signal_array_getbyid(&obj->signals, id);
+    if(!sigfound && !signal_array_getbyid(&lua_class->signals, id))
+    {
+        /* Nobody is listening */
+        lua_pop(L, nargs);
+        return;
+    }
+
     if(sigfound)
     {
         int nbfunc = sigfound->sigfuncs.len;
-        luaL_checkstack(L, nbfunc + nargs + 2, "too much signal");
+        int args = lua_gettop(L) - nargs + 1;
+        luaL_checkstack(L, nbfunc + nargs + 3, "too much signal");
+        luaA_pusherrorhandler(L);
+        int errfunc = lua_gettop(L);
         /* Push all functions and then execute, because this list can change
          * while executing funcs. */
         foreach(func, sigfound->sigfuncs)
             luaA_object_push_item(L, oud_abs, *func);
 
-        for(int i = 0; i < nbfunc; i++)
+        for(int i = 1; i <= nbfunc; i++)
         {
+            lua_pushvalue(L, errfunc + i);
             /* push object */
             lua_pushvalue(L, oud_abs);
             /* push all args */
             for(int j = 0; j < nargs; j++)
-                lua_pushvalue(L, - nargs - nbfunc - 1 + i);
-            /* push first function */
-            lua_pushvalue(L, - nargs - nbfunc - 1 + i);
-            /* remove this first function */
-            lua_remove(L, - nargs - nbfunc - 2 + i);
-            luaA_dofunction(L, nargs + 1, 0);
+                lua_pushvalue(L, args + j);
+            luaA_pcall(L, nargs + 1, 0, errfunc);
         }
+
+        /* remove functions and error handler */
+        lua_pop(L, nbfunc + 1);
     }
 
     /* Then emit signal on the class */
-    lua_pushvalue(L, oud);
+    lua_pushvalue(L, oud_abs);
     lua_insert(L, - nargs - 1);
-    luaA_class_emit_signal(L, luaA_class_get(L, - nargs - 1), name, nargs + 1);
+    signal_object_emit(L, &lua_class->signals, id, nargs + 1);
 }
 
 int
 luaA_object_connect_signal_simple(lua_State *L)
 {
-    luaA_object_connect_signal_from_stack(L, 1, luaL_checkstring(L, 2), 3);
+    luaA_object_connect_signal_from_stack(L, 1, luaA_checksignal(L, 2), 3);
     return 0;
 }
 
 int
 luaA_object_disconnect_signal_simple(lua_State *L)
 {
-    luaA_object_disconnect_signal_from_stack(L, 1, luaL_checkstring(L, 2), 3);
+    luaA_object_disconnect_signal_from_stack(L, 1, luaA_lookupsignal(L, 2), 3);
     return 0;
 }
 
 int
 luaA_object_emit_signal_simple(lua_State *L)
 {
-    luaA_object_emit_signal(L, 1, luaL_checkstring(L, 2), lua_gettop(L) - 2);
+    signal_id_t id = luaA_lookupsignal(L, 2);
+    /* Nobody ever connected to this name */
+    if(id)
+        luaA_object_emit_signal(L, 1, id, lua_gettop(L) - 2);
     return 0;
 }
 
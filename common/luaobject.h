@@ -107,24 +107,37 @@ luaA_object_ref(lua_State *L, int oud)
     return p;
 }
 
-/** Reference an object and return a pointer to it checking its type.
- * That only works with userdata.
+/** Reference an object of a class and return a pointer to it.
+ * The reference count is kept in the object itself, so the registry is only
+ * touched when the first reference is taken. Such objects must be released
+ * with luaA_object_unref_class(), never with luaA_object_unref().
  * \param L The Lua VM state.
  * \param oud The object index on the stack.
  * \param class The class of object expected
- * \return The object reference, or NULL if not referenceable.
+ * \return The object reference.
  */
 static inline void *
 luaA_object_ref_class(lua_State *L, int oud, lua_class_t *class)
 {
-    luaA_checkudata(L, oud, class);
-    return luaA_object_ref(L, oud);
+    lua_object_t *obj = luaA_checkudata(L, oud, class);
+
+    if(obj->refcount++ == 0)
+    {
+        luaA_object_registry_push(L);
+        lua_pushlightuserdata(L, obj);
+        lua_pushvalue(L, oud < 0 ? oud - 2 : oud);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+    }
+
+    lua_remove(L, oud);
+    return obj;
 }
 
-/** Unreference an object and return a pointer to it.
+/** Unreference an object.
  * That only works with userdata, table, thread or function.
  * \param L The Lua VM state.
- * \param oud The object index on the stack.
+ * \param pointer The object pointer.
  */
 static inline void
 luaA_object_unref(lua_State *L, const void *pointer)
@@ -134,6 +147,38 @@ luaA_object_unref(lua_State *L, const void *pointer)
     lua_pop(L, 1);
 }
 
+void luaA_object_unref_class_warn(const void *);
+
+/** Unreference an object referenced with luaA_object_ref_class().
+ * The object is only removed from the registry once its last reference is
+ * gone, after which it can be garbage collected.
+ * \param L The Lua VM state.
+ * \param pointer The object pointer.
+ */
+static inline void
+luaA_object_unref_class(lua_State *L, void *pointer)
+{
+    lua_object_t *obj = pointer;
+
+    if(!obj)
+        return;
+
+    if(obj->refcount == 0)
+    {
+        luaA_object_unref_class_warn(obj);
+        return;
+    }
+
+    if(--obj->refcount == 0)
+    {
+        luaA_object_registry_push(L);
+        lua_pushlightuserdata(L, obj);
+        lua_pushnil(L);
+        lua_rawset(L, -3);
+        lua_pop(L, 1);
+    }
+}
+
 /** Push a referenced object onto the stack.
  * \param L The Lua VM state.
  * \param pointer The object to push.
@@ -149,13 +194,27 @@ luaA_object_push(lua_State *L, const void *pointer)
     return 1;
 }
 
-void signal_object_emit(lua_State *, signal_array_t *, const char *, int);
+void signal_object_emit(lua_State *, signal_array_t *, signal_id_t, int);
 
 void luaA_object_connect_signal(lua_State *, int, const char *, lua_CFunction);
 void luaA_object_disconnect_signal(lua_State *, int, const char *, lua_CFunction);
-void luaA_object_connect_signal_from_stack(lua_State *, int, const char *, int);
-void luaA_object_disconnect_signal_from_stack(lua_State *, int, const char *, int);
-void luaA_object_emit_signal(lua_State *, int, const char *, int);
+void luaA_object_connect_signal_from_stack(lua_State *, int, signal_id_t, int);
+void luaA_object_disconnect_signal_from_stack(lua_State *, int, signal_id_t, int);
+void luaA_object_emit_signal(lua_State *, int, signal_id_t, int);
+
+/** Check if emitting a signal on an object would call any function, so that
+ * emit sites can avoid building arguments that nobody looks at.
+ * \param lua_class The class of the object.
+ * \param obj The object.
+ * \param id The signal identifier.
+ * \return True if the object or its class has a handler for this signal.
+ */
+static inline bool
+luaA_object_has_listeners(lua_class_t *lua_class, void *obj, signal_id_t id)
+{
+    return signal_array_getbyid(&((lua_object_t *) obj)->signals, id)
+        || signal_array_getbyid(&lua_class->signals, id);
+}
 
 int luaA_object_connect_signal_simple(lua_State *);
 int luaA_object_disconnect_signal_simple(lua_State *);
@@ -177,7 +236,7 @@ int luaA_object_emit_signal_simple(lua_State *);
         lua_setfield(L, -2, "data");                                           \
         luaA_setuservalue(L, -2);                                              \
         lua_pushvalue(L, -1);                                                  \
-        luaA_class_emit_signal(L, &(lua_class), "new", 1);                     \
+        luaA_class_emit_signal(L, &(lua_class), SIGNAL_ID("new"), 1);          \
         return p;                                                              \
     }
 
@@ -0,0 +1,84 @@
+/*
+ * common/signal.c - Signal name interning
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "common/signal.h"
+
+#include <glib.h>
+
+/** Map from signal names to their identifiers */
+static GHashTable *signal_ids;
+/** Map from signal identifiers to their names, index 0 is unused */
+static char **signal_names;
+static signal_id_t signal_names_size;
+static signal_id_t signal_count;
+
+/** Get the identifier of a signal name, allocating a new one if this name was
+ * never seen before. Names are compared in full, so two different names can
+ * never end up with the same identifier.
+ * \param name The signal name.
+ * \return The signal identifier, never 0.
+ */
+signal_id_t
+signal_intern(const char *name)
+{
+    gpointer id;
+
+    if(!signal_ids)
+        signal_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    else if((id = g_hash_table_lookup(signal_ids, name)))
+        return GPOINTER_TO_SIZE(id);
+
+    if(++signal_count >= signal_names_size)
+    {
+        signal_names_size = p_alloc_nr(signal_names_size);
+        p_realloc(&signal_names, signal_names_size);
+    }
+
+    signal_names[signal_count] = a_strdup(name);
+    g_hash_table_insert(signal_ids, signal_names[signal_count],
+                        GSIZE_TO_POINTER(signal_count));
+
+    return signal_count;
+}
+
+/** Get the identifier of a signal name without interning it.
+ * \param name The signal name.
+ * \return The signal identifier, or 0 if this name was never interned.
+ */
+signal_id_t
+signal_lookup(const char *name)
+{
+    if(!signal_ids)
+        return 0;
+    return GPOINTER_TO_SIZE(g_hash_table_lookup(signal_ids, name));
+}
+
+/** Get the name of an interned signal.
+ * \param id The signal identifier.
+ * \return The signal name.
+ */
+const char *
+signal_name(signal_id_t id)
+{
+    if(id == 0 || id > signal_count)
+        return NULL;
+    return signal_names[id];
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
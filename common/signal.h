@@ -26,9 +26,27 @@
 
 DO_ARRAY(const void *, cptr, DO_NOTHING)
 
+/** Interned signal name, see signal_intern() */
+typedef unsigned long signal_id_t;
+
+signal_id_t signal_intern(const char *);
+signal_id_t signal_lookup(const char *);
+const char * signal_name(signal_id_t);
+
+/** Get the identifier of a constant signal name. The name is only interned
+ * the first time this is evaluated, so this must only be used with literals.
+ * \param name The signal name, a string literal.
+ * \return The signal identifier.
+ */
+#define SIGNAL_ID(name) \
+    ({ static signal_id_t __signal_id; \
+       if(!__signal_id) \
+           __signal_id = signal_intern("" name); \
+       __signal_id; })
+
 typedef struct
 {
-    unsigned long id;
+    signal_id_t id;
     cptr_array_t sigfuncs;
 } signal_t;
 
@@ -48,7 +66,7 @@ signal_wipe(signal_t *sig)
 DO_BARRAY(signal_t, signal, signal_wipe, signal_cmp)
 
 static inline signal_t *
-signal_array_getbyid(signal_array_t *arr, unsigned long id)
+signal_array_getbyid(signal_array_t *arr, signal_id_t id)
 {
     signal_t sig = { .id = id };
     return signal_array_lookup(arr, &sig);
@@ -57,19 +75,18 @@ signal_array_getbyid(signal_array_t *arr, unsigned long id)
 /** Connect a signal inside a signal array.
  * You are in charge of reference counting.
  * \param arr The signal array.
- * \param name The signal name.
+ * \param id The signal identifier.
  * \param ref The reference to add.
  */
 static inline void
-signal_connect(signal_array_t *arr, const char *name, const void *ref)
+signal_connect(signal_array_t *arr, signal_id_t id, const void *ref)
 {
-    unsigned long tok = a_strhash((const unsigned char *) name);
-    signal_t *sigfound = signal_array_getbyid(arr, tok);
+    signal_t *sigfound = signal_array_getbyid(arr, id);
     if(sigfound)
         cptr_array_append(&sigfound->sigfuncs, ref);
     else
     {
-        signal_t sig = { .id = tok };
+        signal_t sig = { .id = id };
         cptr_array_append(&sig.sigfuncs, ref);
         signal_array_insert(arr, sig);
     }
@@ -78,14 +95,13 @@ signal_connect(signal_array_t *arr, const char *name, const void *ref)
 /** Disconnect a signal inside a signal array.
  * You are in charge of reference counting.
  * \param arr The signal array.
- * \param name The signal name.
+ * \param id The signal identifier.
  * \param ref The reference to remove.
  */
 static inline bool
-signal_disconnect(signal_array_t *arr, const char *name, const void *ref)
+signal_disconnect(signal_array_t *arr, signal_id_t id, const void *ref)
 {
-    signal_t *sigfound = signal_array_getbyid(arr,
-                                              a_strhash((const unsigned char *) name));
+    signal_t *sigfound = signal_array_getbyid(arr, id);
     if(sigfound)
     {
         foreach(func, sigfound->sigfuncs)
@@ -411,16 +411,17 @@ a_dbus_process_request(DBusConnection *dbus_connection, DBusMessage *msg)
 
     if(dbus_message_get_no_reply(msg))
     {
-        signal_t *sigfound = signal_array_getbyid(&dbus_signals,
-                                                  a_strhash((const unsigned char *) NONULL(interface)));
+        /* Only look the name up: peers must not grow the table of names */
+        signal_id_t id = signal_lookup(NONULL(interface));
+        signal_t *sigfound = signal_array_getbyid(&dbus_signals, id);
         /* emit signals */
         if(sigfound)
-            signal_object_emit(L, &dbus_signals, NONULL(interface), nargs);
+            signal_object_emit(L, &dbus_signals, id, nargs);
     }
     else
     {
         signal_t *sig = signal_array_getbyid(&dbus_signals,
-                                             a_strhash((const unsigned char *) NONULL(interface)));
+                                             signal_lookup(NONULL(interface)));
         if(sig)
         {
             /* there can be only ONE handler to send reply */
@@ -768,16 +769,16 @@ static int
 luaA_dbus_connect_signal(lua_State *L)
 {
     const char *name = luaL_checkstring(L, 1);
+    signal_id_t id = luaA_checksignal(L, 1);
     luaA_checkfunction(L, 2);
-    signal_t *sig = signal_array_getbyid(&dbus_signals,
-                                         a_strhash((const unsigned char *) name));
+    signal_t *sig = signal_array_getbyid(&dbus_signals, id);
     if(sig) {
         luaA_warn(L, "cannot add signal %s on D-Bus, already existing", name);
         lua_pushnil(L);
         lua_pushfstring(L, "cannot add signal %s on D-Bus, already existing", name);
         return 2;
     } else {
-        signal_connect(&dbus_signals, name, luaA_object_ref(L, 2));
+        signal_connect(&dbus_signals, id, luaA_object_ref(L, 2));
         lua_pushboolean(L, 1);
         return 1;
     }
@@ -792,10 +793,10 @@ luaA_dbus_connect_signal(lua_State *L)
 static int
 luaA_dbus_disconnect_signal(lua_State *L)
 {
-    const char *name = luaL_checkstring(L, 1);
+    signal_id_t id = luaA_lookupsignal(L, 1);
     luaA_checkfunction(L, 2);
     const void *func = lua_topointer(L, 2);
-    if (signal_disconnect(&dbus_signals, name, func))
+    if (signal_disconnect(&dbus_signals, id, func))
         luaA_object_unref(L, func);
     return 0;
 }
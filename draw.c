@@ -21,6 +21,7 @@
 
 #include "config.h"
 #include "draw.h"
+#include "draw_kernels.h"
 #include "globalconf.h"
 
 #include <langinfo.h>
@@ -87,6 +88,22 @@ draw_iso2utf8(const char *iso, size_t len, char **dest, ssize_t *dlen)
     return true;
 }
 
+static const draw_kernels_t *draw_kernels;
+
+/** Pick the pixel conversion kernels. These are the fastest ones the CPU
+ * supports, unless AWESOME_DRAW_KERNELS names another set.
+ */
+static void
+draw_kernels_init(void)
+{
+    const char *name = getenv("AWESOME_DRAW_KERNELS");
+
+    if(name && !(draw_kernels = draw_kernels_find(name)))
+        warn("Pixel conversion kernels \"%s\" are not available", name);
+    if(!draw_kernels)
+        draw_kernels = draw_kernels_find(NULL);
+}
+
 static cairo_user_data_key_t data_key;
 
 static inline void
@@ -105,20 +122,14 @@ cairo_surface_t *
 draw_surface_from_data(int width, int height, uint32_t *data)
 {
     unsigned long int len = width * height;
-    unsigned long int i;
     uint32_t *buffer = p_new(uint32_t, len);
     cairo_surface_t *surface;
 
+    if(!draw_kernels)
+        draw_kernels_init();
+
     /* Cairo wants premultiplied alpha, meh :( */
-    for(i = 0; i < len; i++)
-    {
-        uint8_t a = (data[i] >> 24) & 0xff;
-        double alpha = a / 255.0;
-        uint8_t r = ((data[i] >> 16) & 0xff) * alpha;
-        uint8_t g = ((data[i] >>  8) & 0xff) * alpha;
-        uint8_t b = ((data[i] >>  0) & 0xff) * alpha;
-        buffer[i] = (a << 24) | (r << 16) | (g << 8) | b;
-    }
+    draw_kernels->premultiply_argb32(buffer, data, len);
 
     surface =
         cairo_image_surface_create_for_data((unsigned char *) buffer,
@@ -157,29 +168,15 @@ draw_surface_from_pixbuf(GdkPixbuf *buf)
     cairo_stride = cairo_image_surface_get_stride(surface);
     cairo_pixels = cairo_image_surface_get_data(surface);
 
+    if(!draw_kernels)
+        draw_kernels_init();
+
     for (int y = 0; y < height; y++)
     {
-        guchar *row = pixels;
-        uint32_t *cairo = (uint32_t *) cairo_pixels;
-        for (int x = 0; x < width; x++) {
-            if (channels == 3)
-            {
-                uint8_t r = *row++;
-                uint8_t g = *row++;
-                uint8_t b = *row++;
-                *cairo++ = (r << 16) | (g << 8) | b;
-            } else {
-                uint8_t r = *row++;
-                uint8_t g = *row++;
-                uint8_t b = *row++;
-                uint8_t a = *row++;
-                double alpha = a / 255.0;
-                r = r * alpha;
-                g = g * alpha;
-                b = b * alpha;
-                *cairo++ = (a << 24) | (r << 16) | (g << 8) | b;
-            }
-        }
+        if (channels == 3)
+            draw_kernels->rgb_to_rgb24((uint32_t *) cairo_pixels, pixels, width);
+        else
+            draw_kernels->rgba_to_argb32((uint32_t *) cairo_pixels, pixels, width);
         pixels += pix_stride;
         cairo_pixels += cairo_stride;
     }
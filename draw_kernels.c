@@ -0,0 +1,264 @@
+/*
+ * draw_kernels.c - pixel conversion kernels
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "draw_kernels.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DRAW_HAVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+static void
+draw_premultiply_argb32_scalar(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t a = (src[i] >> 24) & 0xff;
+        uint8_t r = draw_premultiply_channel((src[i] >> 16) & 0xff, a);
+        uint8_t g = draw_premultiply_channel((src[i] >>  8) & 0xff, a);
+        uint8_t b = draw_premultiply_channel((src[i] >>  0) & 0xff, a);
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+static void
+draw_rgba_to_argb32_scalar(uint32_t *dst, const uint8_t *src, size_t len)
+{
+    for(size_t i = 0; i < len; i++, src += 4)
+    {
+        uint8_t a = src[3];
+        uint8_t r = draw_premultiply_channel(src[0], a);
+        uint8_t g = draw_premultiply_channel(src[1], a);
+        uint8_t b = draw_premultiply_channel(src[2], a);
+        dst[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+}
+
+static void
+draw_rgb_to_rgb24_scalar(uint32_t *dst, const uint8_t *src, size_t len)
+{
+    for(size_t i = 0; i < len; i++, src += 3)
+        dst[i] = (src[0] << 16) | (src[1] << 8) | src[2];
+}
+
+#ifdef DRAW_HAVE_X86_KERNELS
+/* The vector kernels work on 16 bit lanes holding the channels of a pixel in
+ * B, G, R, A order, which is the in-memory order of CAIRO_FORMAT_ARGB32 on
+ * x86. They compute exactly the same as draw_premultiply_channel().
+ */
+
+/** Premultiply the two pixels in a vector of 16 bit lanes. */
+__attribute__((target("sse2")))
+static inline __m128i
+draw_premultiply_epi16_sse2(__m128i v)
+{
+    /* Broadcast alpha to all lanes of a pixel, but multiply alpha itself by
+     * 255 so that it stays unchanged */
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)),
+                                        _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_or_si128(alpha, _mm_set_epi16(0xff, 0, 0, 0, 0xff, 0, 0, 0));
+    v = _mm_mullo_epi16(v, alpha);
+    v = _mm_add_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), _mm_set1_epi16(1));
+    return _mm_srli_epi16(v, 8);
+}
+
+/** Premultiply the four pixels in a vector of 16 bit lanes. */
+__attribute__((target("avx2")))
+static inline __m256i
+draw_premultiply_epi16_avx2(__m256i v)
+{
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)),
+                                           _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm256_or_si256(alpha, _mm256_set_epi16(0xff, 0, 0, 0, 0xff, 0, 0, 0,
+                                                    0xff, 0, 0, 0, 0xff, 0, 0, 0));
+    v = _mm256_mullo_epi16(v, alpha);
+    v = _mm256_add_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(v, 8);
+}
+
+__attribute__((target("sse2")))
+static void
+draw_premultiply_argb32_sse2(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for(; i + 4 <= len; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        lo = draw_premultiply_epi16_sse2(lo);
+        hi = draw_premultiply_epi16_sse2(hi);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+
+    draw_premultiply_argb32_scalar(dst + i, src + i, len - i);
+}
+
+__attribute__((target("sse2")))
+static void
+draw_rgba_to_argb32_sse2(uint32_t *dst, const uint8_t *src, size_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for(; i + 4 <= len; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + 4 * i));
+        /* Swap R and B to go from R, G, B, A to B, G, R, A */
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 0, 1, 2)),
+                                 _MM_SHUFFLE(3, 0, 1, 2));
+        hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 0, 1, 2)),
+                                 _MM_SHUFFLE(3, 0, 1, 2));
+        lo = draw_premultiply_epi16_sse2(lo);
+        hi = draw_premultiply_epi16_sse2(hi);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+
+    draw_rgba_to_argb32_scalar(dst + i, src + 4 * i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void
+draw_premultiply_argb32_avx2(uint32_t *dst, const uint32_t *src, size_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for(; i + 8 <= len; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+        /* Unpacking and packing both work within 128 bit lanes, so the pixel
+         * order is preserved */
+        __m256i lo = _mm256_unpacklo_epi8(v, zero);
+        __m256i hi = _mm256_unpackhi_epi8(v, zero);
+        lo = draw_premultiply_epi16_avx2(lo);
+        hi = draw_premultiply_epi16_avx2(hi);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+
+    draw_premultiply_argb32_sse2(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void
+draw_rgba_to_argb32_avx2(uint32_t *dst, const uint8_t *src, size_t len)
+{
+    /* Swap R and B within every pixel */
+    const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for(; i + 8 <= len; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *) (src + 4 * i));
+        v = _mm256_shuffle_epi8(v, swap);
+        __m256i lo = _mm256_unpacklo_epi8(v, zero);
+        __m256i hi = _mm256_unpackhi_epi8(v, zero);
+        lo = draw_premultiply_epi16_avx2(lo);
+        hi = draw_premultiply_epi16_avx2(hi);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+
+    draw_rgba_to_argb32_sse2(dst + i, src + 4 * i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void
+draw_rgb_to_rgb24_avx2(uint32_t *dst, const uint8_t *src, size_t len)
+{
+    /* Spread 4 pixels of 3 bytes to 4 pixels of 4 bytes, in B, G, R, X order */
+    const __m128i spread = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1,
+                                         8, 7, 6, -1, 11, 10, 9, -1);
+    size_t i = 0;
+
+    /* Every load reads 16 bytes but only uses 12 of them, so stop early
+     * enough to never read past the end of the row */
+    for(; 3 * i + 16 <= 3 * len; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) (src + 3 * i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_shuffle_epi8(v, spread));
+    }
+
+    draw_rgb_to_rgb24_scalar(dst + i, src + 3 * i, len - i);
+}
+
+#endif
+
+static const draw_kernels_t draw_kernels_scalar =
+{
+    .name = "scalar",
+    .premultiply_argb32 = draw_premultiply_argb32_scalar,
+    .rgba_to_argb32 = draw_rgba_to_argb32_scalar,
+    .rgb_to_rgb24 = draw_rgb_to_rgb24_scalar,
+};
+
+#ifdef DRAW_HAVE_X86_KERNELS
+static const draw_kernels_t draw_kernels_sse2 =
+{
+    .name = "sse2",
+    .premultiply_argb32 = draw_premultiply_argb32_sse2,
+    .rgba_to_argb32 = draw_rgba_to_argb32_sse2,
+    .rgb_to_rgb24 = draw_rgb_to_rgb24_scalar,
+};
+
+static const draw_kernels_t draw_kernels_avx2 =
+{
+    .name = "avx2",
+    .premultiply_argb32 = draw_premultiply_argb32_avx2,
+    .rgba_to_argb32 = draw_rgba_to_argb32_avx2,
+    .rgb_to_rgb24 = draw_rgb_to_rgb24_avx2,
+};
+#endif
+
+/** Get a set of pixel conversion kernels.
+ * \param name The name of the set, or NULL for the fastest one the CPU
+ * supports.
+ * \return The kernels, or NULL if the set is unknown or the CPU does not
+ * support it.
+ */
+const draw_kernels_t *
+draw_kernels_find(const char *name)
+{
+#ifdef DRAW_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+    bool has_sse2 = __builtin_cpu_supports("sse2");
+
+    if(!name)
+        return has_avx2 ? &draw_kernels_avx2
+            : has_sse2 ? &draw_kernels_sse2 : &draw_kernels_scalar;
+    if(has_avx2 && !strcmp(name, draw_kernels_avx2.name))
+        return &draw_kernels_avx2;
+    if(has_sse2 && !strcmp(name, draw_kernels_sse2.name))
+        return &draw_kernels_sse2;
+#endif
+    if(!name || !strcmp(name, draw_kernels_scalar.name))
+        return &draw_kernels_scalar;
+    return NULL;
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,52 @@
+/*
+ * draw_kernels.h - pixel conversion kernels
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AWESOME_DRAW_KERNELS_H
+#define AWESOME_DRAW_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Premultiply a color channel with an alpha value.
+ * This is c * a / 255 rounded down, computed without a division.
+ */
+static inline uint8_t
+draw_premultiply_channel(uint8_t c, uint8_t a)
+{
+    unsigned int x = c * a;
+    return (x + (x >> 8) + 1) >> 8;
+}
+
+/** A set of pixel conversion kernels. All sets compute the same results. */
+typedef struct
+{
+    /** The name of the set: "scalar", "sse2" or "avx2" */
+    const char *name;
+    /** Premultiply unpremultiplied ARGB32 pixels */
+    void (*premultiply_argb32)(uint32_t *, const uint32_t *, size_t);
+    /** Convert R, G, B, A bytes to premultiplied ARGB32 pixels */
+    void (*rgba_to_argb32)(uint32_t *, const uint8_t *, size_t);
+    /** Convert R, G, B bytes to RGB24 pixels */
+    void (*rgb_to_rgb24)(uint32_t *, const uint8_t *, size_t);
+} draw_kernels_t;
+
+const draw_kernels_t *draw_kernels_find(const char *);
+
+#endif
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
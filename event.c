@@ -71,12 +71,12 @@
               case xcbeventprefix##_PRESS: \
                 for(int i = 0; i < nargs; i++) \
                     lua_pushvalue(L, - nargs - item_matching); \
-                luaA_object_emit_signal(L, - nargs - 1, "press", nargs); \
+                luaA_object_emit_signal(L, - nargs - 1, SIGNAL_ID("press"), nargs); \
                 break; \
               case xcbeventprefix##_RELEASE: \
                 for(int i = 0; i < nargs; i++) \
                     lua_pushvalue(L, - nargs - item_matching); \
-                luaA_object_emit_signal(L, - nargs - 1, "release", nargs); \
+                luaA_object_emit_signal(L, - nargs - 1, SIGNAL_ID("release"), nargs); \
                 break; \
             } \
             lua_pop(L, 1); \
@@ -140,14 +140,14 @@ event_handle_mousegrabber(int x, int y, uint16_t mask)
 static void
 event_emit_button(lua_State *L, xcb_button_press_event_t *ev)
 {
-    const char *name;
+    signal_id_t name;
     switch(XCB_EVENT_RESPONSE_TYPE(ev))
     {
     case XCB_BUTTON_PRESS:
-        name = "button::press";
+        name = SIGNAL_ID("button::press");
         break;
     case XCB_BUTTON_RELEASE:
-        name = "button::release";
+        name = SIGNAL_ID("button::release");
         break;
     default:
         fatal("Invalid event type");
@@ -396,6 +396,7 @@ event_handle_configurerequest(xcb_configure_request_event_t *ev)
         }
 
         c->got_configure_request = true;
+        client_geometry_need_update(c);
         client_resize(c, geometry, false);
     }
     else if (xembed_getbywin(&globalconf.embedded, ev->window))
@@ -476,13 +477,18 @@ event_drawable_under_mouse(lua_State *L, int ud)
 {
     void *d;
 
-    lua_pushvalue(L, ud);
-    d = luaA_object_ref(L, -1);
+    if(lua_isnil(L, ud))
+        d = NULL;
+    else
+    {
+        lua_pushvalue(L, ud);
+        d = luaA_object_ref_class(L, -1, &drawable_class);
+    }
 
     if (d == globalconf.drawable_under_mouse)
     {
         /* Nothing to do */
-        luaA_object_unref(L, d);
+        luaA_object_unref_class(L, d);
         return;
     }
 
@@ -490,11 +496,11 @@ event_drawable_under_mouse(lua_State *L, int ud)
     {
         /* Emit leave on previous drawable */
         luaA_object_push(L, globalconf.drawable_under_mouse);
-        luaA_object_emit_signal(L, -1, "mouse::leave", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("mouse::leave"), 0);
         lua_pop(L, 1);
 
         /* Unref the previous drawable */
-        luaA_object_unref(L, globalconf.drawable_under_mouse);
+        luaA_object_unref_class(L, globalconf.drawable_under_mouse);
         globalconf.drawable_under_mouse = NULL;
     }
     if (d != NULL)
@@ -503,7 +509,7 @@ event_drawable_under_mouse(lua_State *L, int ud)
         globalconf.drawable_under_mouse = d;
 
         /* Emit enter */
-        luaA_object_emit_signal(L, ud, "mouse::enter", 0);
+        luaA_object_emit_signal(L, ud, SIGNAL_ID("mouse::enter"), 0);
     }
 }
 
@@ -525,9 +531,12 @@ event_handle_motionnotify(xcb_motion_notify_event_t *ev)
     if((c = client_getbyframewin(ev->event)))
     {
         luaA_object_push(L, c);
-        lua_pushinteger(L, ev->event_x);
-        lua_pushinteger(L, ev->event_y);
-        luaA_object_emit_signal(L, -3, "mouse::move", 2);
+        if(luaA_object_has_listeners(&client_class, c, SIGNAL_ID("mouse::move")))
+        {
+            lua_pushinteger(L, ev->event_x);
+            lua_pushinteger(L, ev->event_y);
+            luaA_object_emit_signal(L, -3, SIGNAL_ID("mouse::move"), 2);
+        }
 
         /* now check if a titlebar was "hit" */
         int x = ev->event_x, y = ev->event_y;
@@ -536,9 +545,12 @@ event_handle_motionnotify(xcb_motion_notify_event_t *ev)
         {
             luaA_object_push_item(L, -1, d);
             event_drawable_under_mouse(L, -1);
-            lua_pushinteger(L, x);
-            lua_pushinteger(L, y);
-            luaA_object_emit_signal(L, -3, "mouse::move", 2);
+            if(luaA_object_has_listeners(&drawable_class, d, SIGNAL_ID("mouse::move")))
+            {
+                lua_pushinteger(L, x);
+                lua_pushinteger(L, y);
+                luaA_object_emit_signal(L, -3, SIGNAL_ID("mouse::move"), 2);
+            }
             lua_pop(L, 1);
         }
         lua_pop(L, 1);
@@ -549,9 +561,12 @@ event_handle_motionnotify(xcb_motion_notify_event_t *ev)
         luaA_object_push(L, w);
         luaA_object_push_item(L, -1, w->drawable);
         event_drawable_under_mouse(L, -1);
-        lua_pushinteger(L, ev->event_x);
-        lua_pushinteger(L, ev->event_y);
-        luaA_object_emit_signal(L, -3, "mouse::move", 2);
+        if(luaA_object_has_listeners(&drawable_class, w->drawable, SIGNAL_ID("mouse::move")))
+        {
+            lua_pushinteger(L, ev->event_x);
+            lua_pushinteger(L, ev->event_y);
+            luaA_object_emit_signal(L, -3, SIGNAL_ID("mouse::move"), 2);
+        }
         lua_pop(L, 2);
     }
 }
@@ -576,7 +591,7 @@ event_handle_leavenotify(xcb_leave_notify_event_t *ev)
     if(ev->detail != XCB_NOTIFY_DETAIL_INFERIOR && (c = client_getbyframewin(ev->event)))
     {
         luaA_object_push(L, c);
-        luaA_object_emit_signal(L, -1, "mouse::leave", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("mouse::leave"), 0);
         lua_pop(L, 1);
     }
 
@@ -615,7 +630,7 @@ event_handle_enternotify(xcb_enter_notify_event_t *ev)
          * of a child window, so technically this isn't a 'real' enter.
          */
         if (ev->detail != XCB_NOTIFY_DETAIL_INFERIOR)
-            luaA_object_emit_signal(L, -1, "mouse::enter", 0);
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("mouse::enter"), 0);
 
         drawable_t *d = client_get_drawable(c, ev->event_x, ev->event_y);
         if (d)
@@ -682,10 +697,10 @@ event_handle_expose(xcb_expose_event_t *ev)
     drawin_t *drawin;
     client_t *client;
 
-    if((drawin = drawin_getbywin(ev->window)))
-        drawin_refresh_pixmap_partial(drawin,
-                                      ev->x, ev->y,
-                                      ev->width, ev->height);
+    if((drawin = drawin_getbywin(ev->window)) && drawin->drawable)
+        drawable_add_damage(drawin->drawable,
+                            ev->x, ev->y,
+                            ev->width, ev->height);
     if ((client = client_getbyframewin(ev->window)))
         client_refresh_partial(client, ev->x, ev->y, ev->width, ev->height);
 }
@@ -782,7 +797,10 @@ event_handle_maprequest(xcb_map_request_event_t *ev)
             goto bailout;
         }
 
-        client_manage(ev->window, geom_r, wa_r);
+        client_manage_request_t req;
+        client_manage_prefetch(ev->window, &req);
+        client_manage_prefetch_startup_id(&req);
+        client_manage(ev->window, geom_r, wa_r, &req);
 
         p_delete(&geom_r);
     }
@@ -859,7 +877,7 @@ event_handle_randr_output_change_notify(xcb_randr_notify_event_t *ev)
 
         lua_pushlstring(L, (char *)xcb_randr_get_output_info_name(info), xcb_randr_get_output_info_name_length(info));
         lua_pushstring(L, connection_str);
-        signal_object_emit(L, &global_signals, "screen::change", 2);
+        signal_object_emit(L, &global_signals, SIGNAL_ID("screen::change"), 2);
 
         p_delete(&info);
 
@@ -881,9 +899,9 @@ event_handle_shape_notify(xcb_shape_notify_event_t *ev)
         lua_State *L = globalconf_get_lua_State();
         luaA_object_push(L, c);
         if (ev->shape_kind == XCB_SHAPE_SK_BOUNDING)
-            luaA_object_emit_signal(L, -1, "property::shape_client_bounding", 0);
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("property::shape_client_bounding"), 0);
         if (ev->shape_kind == XCB_SHAPE_SK_CLIP)
-            luaA_object_emit_signal(L, -1, "property::shape_client_clip", 0);
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("property::shape_client_clip"), 0);
         lua_pop(L, 1);
     }
 }
@@ -34,6 +34,12 @@ void luaA_emit_refresh(void);
 /* objects/drawin.c */
 void drawin_refresh(void);
 
+/* objects/drawable.c */
+void drawable_refresh(void);
+
+/* objects/window.c */
+void window_refresh(void);
+
 /* objects/client.c */
 void client_refresh(void);
 void client_focus_refresh(void);
@@ -42,15 +48,22 @@ void client_destroy_later(void);
 /* objects/screen.c */
 void screen_refresh(void);
 
+/* ewmh.c */
+void ewmh_refresh(void);
+
 static inline int
 awesome_refresh(void)
 {
+    globalconf.stats.refresh++;
     screen_refresh();
     luaA_emit_refresh();
     drawin_refresh();
     client_refresh();
+    drawable_refresh();
+    window_refresh();
     banning_refresh();
     stack_refresh();
+    ewmh_refresh();
     client_destroy_later();
     return xcb_flush(globalconf.connection);
 }
@@ -24,6 +24,7 @@
 #include "objects/tag.h"
 #include "common/atoms.h"
 #include "xwindow.h"
+#include "icon.h"
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -35,6 +36,58 @@
 #define _NET_WM_STATE_ADD 1
 #define _NET_WM_STATE_TOGGLE 2
 
+/** A property on the root window that is only written by ewmh_refresh() */
+typedef struct
+{
+    /** Does the value need to be recomputed? */
+    bool need_update;
+    /** Did we ever write the property? */
+    bool valid;
+    /** The value that was last written */
+    void *data;
+    /** Size of data in bytes */
+    ssize_t size;
+} ewmh_root_property_t;
+
+static ewmh_root_property_t ewmh_client_list;
+static ewmh_root_property_t ewmh_client_list_stacking;
+static ewmh_root_property_t ewmh_desktop_names;
+
+/** Write a property on the root window, unless it already has this value.
+ * \param prop The cached property.
+ * \param atom The property to change.
+ * \param type The type of the property.
+ * \param format The format of the property, 8, 16 or 32.
+ * \param n The number of elements in data.
+ * \param data The new value.
+ */
+static void
+ewmh_root_property_set(ewmh_root_property_t *prop, xcb_atom_t atom,
+                       xcb_atom_t type, uint8_t format, uint32_t n, const void *data)
+{
+    ssize_t size = (ssize_t) n * format / 8;
+
+    prop->need_update = false;
+
+    if(prop->valid && prop->size == size
+       && (size == 0 || memcmp(prop->data, data, size) == 0))
+    {
+        globalconf.stats.ewmh_skipped++;
+        return;
+    }
+
+    p_delete(&prop->data);
+    if(size > 0)
+        prop->data = xmemdup(data, size);
+    prop->size = size;
+    prop->valid = true;
+
+    xcb_change_property(globalconf.connection, XCB_PROP_MODE_REPLACE,
+                        globalconf.screen->root,
+                        atom, type, format, n, data);
+    globalconf.stats.ewmh_updates++;
+}
+
 /** Update client EWMH hints.
  * \param L The Lua VM state.
  */
@@ -92,16 +145,7 @@ ewmh_update_net_active_window(lua_State *L)
 static int
 ewmh_update_net_client_list(lua_State *L)
 {
-    xcb_window_t *wins = p_alloca(xcb_window_t, globalconf.clients.len);
-
-    int n = 0;
-    foreach(client, globalconf.clients)
-        wins[n++] = (*client)->window;
-
-    xcb_change_property(globalconf.connection, XCB_PROP_MODE_REPLACE,
-                        globalconf.screen->root,
-                        _NET_CLIENT_LIST, XCB_ATOM_WINDOW, 32, n, wins);
-
+    ewmh_client_list.need_update = true;
     return 0;
 }
 
@@ -241,20 +285,13 @@ ewmh_init_lua(void)
     luaA_class_connect_signal(L, &tag_class, "property::selected", ewmh_update_net_current_desktop);
 }
 
-/** Set the client list in stacking order, bottom to top.
+/** Mark the client list in stacking order as outdated. It is updated by the
+ * next ewmh_refresh().
  */
 void
 ewmh_update_net_client_list_stacking(void)
 {
-    int n = 0;
-    xcb_window_t *wins = p_alloca(xcb_window_t, globalconf.stack.len);
-
-    foreach(client, globalconf.stack)
-        wins[n++] = (*client)->window;
-
-    xcb_change_property(globalconf.connection, XCB_PROP_MODE_REPLACE,
-			globalconf.screen->root,
-			_NET_CLIENT_LIST_STACKING, XCB_ATOM_WINDOW, 32, n, wins);
+    ewmh_client_list_stacking.need_update = true;
 }
 
 void
@@ -278,23 +315,61 @@ ewmh_update_net_current_desktop(lua_State *L)
     return 0;
 }
 
+/** Mark the desktop names as outdated. They are updated by the next
+ * ewmh_refresh().
+ */
 void
 ewmh_update_net_desktop_names(void)
 {
-    buffer_t buf;
+    ewmh_desktop_names.need_update = true;
+}
 
-    buffer_inita(&buf, BUFSIZ);
+/** Write the outdated root window properties, at most once each. Properties
+ * whose value did not actually change are not written again.
+ */
+void
+ewmh_refresh(void)
+{
+    if(ewmh_client_list.need_update)
+    {
+        xcb_window_t *wins = p_alloca(xcb_window_t, globalconf.clients.len);
+        int n = 0;
 
-    foreach(tag, globalconf.tags)
+        foreach(client, globalconf.clients)
+            wins[n++] = (*client)->window;
+
+        ewmh_root_property_set(&ewmh_client_list, _NET_CLIENT_LIST,
+                               XCB_ATOM_WINDOW, 32, n, wins);
+    }
+
+    if(ewmh_client_list_stacking.need_update)
     {
-        buffer_adds(&buf, tag_get_name(*tag));
-        buffer_addc(&buf, '\0');
+        xcb_window_t *wins = p_alloca(xcb_window_t, globalconf.stack.len);
+        int n = 0;
+
+        foreach(client, globalconf.stack)
+            wins[n++] = (*client)->window;
+
+        ewmh_root_property_set(&ewmh_client_list_stacking, _NET_CLIENT_LIST_STACKING,
+                               XCB_ATOM_WINDOW, 32, n, wins);
     }
 
-    xcb_change_property(globalconf.connection, XCB_PROP_MODE_REPLACE,
-			globalconf.screen->root,
-			_NET_DESKTOP_NAMES, UTF8_STRING, 8, buf.len, buf.s);
-    buffer_wipe(&buf);
+    if(ewmh_desktop_names.need_update)
+    {
+        buffer_t buf;
+
+        buffer_inita(&buf, BUFSIZ);
+
+        foreach(tag, globalconf.tags)
+        {
+            buffer_adds(&buf, tag_get_name(*tag));
+            buffer_addc(&buf, '\0');
+        }
+
+        ewmh_root_property_set(&ewmh_desktop_names, _NET_DESKTOP_NAMES,
+                               UTF8_STRING, 8, buf.len, buf.s);
+        buffer_wipe(&buf);
+    }
 }
 
 static void
@@ -388,15 +463,15 @@ ewmh_process_state_atom(client_t *c, xcb_atom_t state, int set)
     {
         if(set == _NET_WM_STATE_REMOVE) {
             lua_pushboolean(L, false);
-            luaA_object_emit_signal(L, -2, "request::urgent", 1);
+            luaA_object_emit_signal(L, -2, SIGNAL_ID("request::urgent"), 1);
         }
         else if(set == _NET_WM_STATE_ADD) {
             lua_pushboolean(L, true);
-            luaA_object_emit_signal(L, -2, "request::urgent", 1);
+            luaA_object_emit_signal(L, -2, SIGNAL_ID("request::urgent"), 1);
         }
         else if(set == _NET_WM_STATE_TOGGLE) {
             lua_pushboolean(L, !c->urgent);
-            luaA_object_emit_signal(L, -2, "request::urgent", 1);
+            luaA_object_emit_signal(L, -2, SIGNAL_ID("request::urgent"), 1);
         }
     }
 
@@ -412,7 +487,7 @@ ewmh_process_desktop(client_t *c, uint32_t desktop)
     {
         luaA_object_push(L, c);
         lua_pushboolean(L, true);
-        luaA_object_emit_signal(L, -2, "request::tag", 1);
+        luaA_object_emit_signal(L, -2, SIGNAL_ID("request::tag"), 1);
         /* Pop the client, arguments are already popped */
         lua_pop(L, 1);
     }
@@ -420,7 +495,7 @@ ewmh_process_desktop(client_t *c, uint32_t desktop)
     {
         luaA_object_push(L, c);
         luaA_object_push(L, globalconf.tags.tab[idx]);
-        luaA_object_emit_signal(L, -2, "request::tag", 1);
+        luaA_object_emit_signal(L, -2, SIGNAL_ID("request::tag"), 1);
         /* Pop the client, arguments are already popped */
         lua_pop(L, 1);
     }
@@ -438,7 +513,7 @@ ewmh_process_client_message(xcb_client_message_event_t *ev)
         {
             lua_State *L = globalconf_get_lua_State();
             luaA_object_push(L, globalconf.tags.tab[idx]);
-            luaA_object_emit_signal(L, -1, "request::select", 0);
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("request::select"), 0);
             lua_pop(L, 1);
         }
     }
@@ -477,7 +552,7 @@ ewmh_process_client_message(xcb_client_message_event_t *ev)
             lua_pushboolean(L, true);
             lua_settable(L, -3);
 
-            luaA_object_emit_signal(L, -3, "request::activate", 2);
+            luaA_object_emit_signal(L, -3, SIGNAL_ID("request::activate"), 2);
             lua_pop(L, 1);
         }
     }
@@ -547,25 +622,35 @@ ewmh_update_window_type(xcb_window_t window, uint32_t type)
                         window, _NET_WM_WINDOW_TYPE, XCB_ATOM_ATOM, 32, 1, &type);
 }
 
+/** Send the GetProperty requests for the EWMH hints of a new client.
+ * \param window The client window.
+ * \param cookies Where to store the cookies for ewmh_client_check_hints().
+ */
 void
-ewmh_client_check_hints(client_t *c)
+ewmh_client_get_hints_unchecked(xcb_window_t window, xcb_get_property_cookie_t cookies[3])
 {
-    xcb_atom_t *state;
-    void *data = NULL;
-    xcb_get_property_cookie_t c0, c1, c2;
-    xcb_get_property_reply_t *reply;
+    cookies[0] = xcb_get_property_unchecked(globalconf.connection, false, window,
+                                            _NET_WM_DESKTOP, XCB_GET_PROPERTY_TYPE_ANY, 0, 1);
 
-    /* Send the GetProperty requests which will be processed later */
-    c0 = xcb_get_property_unchecked(globalconf.connection, false, c->window,
-                                    _NET_WM_DESKTOP, XCB_GET_PROPERTY_TYPE_ANY, 0, 1);
+    cookies[1] = xcb_get_property_unchecked(globalconf.connection, false, window,
+                                            _NET_WM_STATE, XCB_ATOM_ATOM, 0, UINT32_MAX);
 
-    c1 = xcb_get_property_unchecked(globalconf.connection, false, c->window,
-                                    _NET_WM_STATE, XCB_ATOM_ATOM, 0, UINT32_MAX);
+    cookies[2] = xcb_get_property_unchecked(globalconf.connection, false, window,
+                                            _NET_WM_WINDOW_TYPE, XCB_ATOM_ATOM, 0, UINT32_MAX);
+}
 
-    c2 = xcb_get_property_unchecked(globalconf.connection, false, c->window,
-                                    _NET_WM_WINDOW_TYPE, XCB_ATOM_ATOM, 0, UINT32_MAX);
+/** Process the EWMH hints of a new client.
+ * \param c The client.
+ * \param cookies The cookies from ewmh_client_get_hints_unchecked().
+ */
+void
+ewmh_client_check_hints(client_t *c, xcb_get_property_cookie_t cookies[3])
+{
+    xcb_atom_t *state;
+    void *data = NULL;
+    xcb_get_property_reply_t *reply;
 
-    reply = xcb_get_property_reply(globalconf.connection, c0, NULL);
+    reply = xcb_get_property_reply(globalconf.connection, cookies[0], NULL);
     if(reply && reply->value_len && (data = xcb_get_property_value(reply)))
     {
         ewmh_process_desktop(c, *(uint32_t *) data);
@@ -573,7 +658,7 @@ ewmh_client_check_hints(client_t *c)
 
     p_delete(&reply);
 
-    reply = xcb_get_property_reply(globalconf.connection, c1, NULL);
+    reply = xcb_get_property_reply(globalconf.connection, cookies[1], NULL);
     if(reply && (data = xcb_get_property_value(reply)))
     {
         state = (xcb_atom_t *) data;
@@ -583,7 +668,7 @@ ewmh_client_check_hints(client_t *c)
 
     p_delete(&reply);
 
-    reply = xcb_get_property_reply(globalconf.connection, c2, NULL);
+    reply = xcb_get_property_reply(globalconf.connection, cookies[2], NULL);
     if(reply && (data = xcb_get_property_value(reply)))
     {
         c->has_NET_WM_WINDOW_TYPE = true;
@@ -609,17 +694,36 @@ ewmh_client_check_hints(client_t *c)
     p_delete(&reply);
 }
 
+/** Send the GetProperty request for the WM strut of a window.
+ * \param window The window.
+ * \return The cookie associated with the request.
+ */
+xcb_get_property_cookie_t
+ewmh_client_strut_get_unchecked(xcb_window_t window)
+{
+    return xcb_get_property_unchecked(globalconf.connection, false, window,
+                                      _NET_WM_STRUT_PARTIAL, XCB_ATOM_CARDINAL, 0, 12);
+}
+
 /** Process the WM strut of a client.
  * \param c The client.
  */
 void
 ewmh_process_client_strut(client_t *c)
+{
+    ewmh_process_client_strut_reply(c, ewmh_client_strut_get_unchecked(c->window));
+}
+
+/** Process the WM strut of a client from an already sent request.
+ * \param c The client.
+ * \param strut_q The cookie from ewmh_client_strut_get_unchecked().
+ */
+void
+ewmh_process_client_strut_reply(client_t *c, xcb_get_property_cookie_t strut_q)
 {
     void *data;
     xcb_get_property_reply_t *strut_r;
 
-    xcb_get_property_cookie_t strut_q = xcb_get_property_unchecked(globalconf.connection, false, c->window,
-                                                                   _NET_WM_STRUT_PARTIAL, XCB_ATOM_CARDINAL, 0, 12);
     strut_r = xcb_get_property_reply(globalconf.connection, strut_q, NULL);
 
     if(strut_r
@@ -656,7 +760,7 @@ ewmh_process_client_strut(client_t *c)
 
             lua_State *L = globalconf_get_lua_State();
             luaA_object_push(L, c);
-            luaA_object_emit_signal(L, -1, "property::struts", 0);
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("property::struts"), 0);
             lua_pop(L, 1);
         }
     }
@@ -675,7 +779,7 @@ ewmh_window_icon_get_unchecked(xcb_window_t w)
                                     _NET_WM_ICON, XCB_ATOM_CARDINAL, 0, UINT32_MAX);
 }
 
-static cairo_surface_t *
+static icon_t *
 ewmh_window_icon_from_reply_next(uint32_t **data, uint32_t *data_end)
 {
     uint32_t width, height;
@@ -695,17 +799,17 @@ ewmh_window_icon_from_reply_next(uint32_t **data, uint32_t *data_end)
 
     icon_data = *data + 2;
     *data += 2 + data_len;
-    return draw_surface_from_data(width, height, icon_data);
+    return icon_new_from_data(width, height, icon_data);
 }
 
-static cairo_surface_array_t
+static icon_array_t
 ewmh_window_icon_from_reply(xcb_get_property_reply_t *r)
 {
     uint32_t *data, *data_end;
-    cairo_surface_array_t result;
-    cairo_surface_t *s;
+    icon_array_t result;
+    icon_t *icon;
 
-    cairo_surface_array_init(&result);
+    icon_array_init(&result);
     if(!r || r->type != XCB_ATOM_CARDINAL || r->format != 32)
         return result;
 
@@ -714,8 +818,8 @@ ewmh_window_icon_from_reply(xcb_get_property_reply_t *r)
     if(!data)
         return result;
 
-    while ((s = ewmh_window_icon_from_reply_next(&data, data_end)) != NULL) {
-        cairo_surface_array_push(&result, s);
+    while ((icon = ewmh_window_icon_from_reply_next(&data, data_end)) != NULL) {
+        icon_array_push(&result, icon);
     }
 
     return result;
@@ -725,11 +829,11 @@ ewmh_window_icon_from_reply(xcb_get_property_reply_t *r)
  * \param cookie The cookie.
  * \return An array of icons.
  */
-cairo_surface_array_t
+icon_array_t
 ewmh_window_icon_get_reply(xcb_get_property_cookie_t cookie)
 {
     xcb_get_property_reply_t *r = xcb_get_property_reply(globalconf.connection, cookie, NULL);
-    cairo_surface_array_t result = ewmh_window_icon_from_reply(r);
+    icon_array_t result = ewmh_window_icon_from_reply(r);
     p_delete(&r);
     return result;
 }
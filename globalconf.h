@@ -36,6 +36,7 @@
 #include "objects/key.h"
 #include "common/xembed.h"
 #include "common/buffer.h"
+#include "common/bitset.h"
 
 #define ROOT_WINDOW_EVENT_MASK \
     (const uint32_t []) { \
@@ -51,6 +52,7 @@
 
 typedef struct drawable_t drawable_t;
 typedef struct drawin_t drawin_t;
+typedef struct window_t window_t;
 typedef struct a_screen screen_t;
 typedef struct button_t button_t;
 typedef struct client_t client_t;
@@ -67,6 +69,8 @@ ARRAY_TYPE(tag_t *, tag)
 ARRAY_TYPE(screen_t *, screen)
 ARRAY_TYPE(client_t *, client)
 ARRAY_TYPE(drawin_t *, drawin)
+ARRAY_TYPE(drawable_t *, drawable)
+ARRAY_TYPE(window_t *, window_object)
 ARRAY_TYPE(xproperty_t, xproperty)
 DO_ARRAY(sequence_pair_t, sequence_pair, DO_NOTHING)
 DO_ARRAY(xcb_window_t, window, DO_NOTHING)
@@ -115,6 +119,8 @@ typedef struct
     uint8_t event_base_randr;
     /** Clients list */
     client_array_t clients;
+    /** Index of client and drawin windows, see window_index_get() */
+    GHashTable *window_index;
     /** Embedded windows */
     xembed_window_array_t embedded;
     /** Stack client history */
@@ -145,6 +151,20 @@ typedef struct
     } focus;
     /** Drawins */
     drawin_array_t drawins;
+    /** Objects with changes that the next awesome_refresh() has to apply */
+    struct
+    {
+        /** Drawins with a pending geometry change */
+        drawin_array_t drawins;
+        /** Clients with a pending geometry change */
+        client_array_t clients;
+        /** Clients and drawins with a pending border change */
+        window_object_array_t borders;
+        /** Clients whose visibility may have changed */
+        client_array_t banning;
+        /** Drawables with damage that has to be copied to the screen */
+        drawable_array_t drawables;
+    } refresh;
     /** The startup notification display struct */
     SnDisplay *sndisplay;
     /** Latest timestamp we got from the X server */
@@ -176,10 +196,12 @@ typedef struct
     uint8_t default_depth;
     /** Our default color map */
     xcb_colormap_t default_cmap;
-    /** Do we have to reban clients? */
-    bool need_lazy_banning;
     /** Tag list */
     tag_array_t tags;
+    /** Bits of the tags that are both activated and selected */
+    bitset_t selected_tags;
+    /** Bits that are currently assigned to a tag */
+    bitset_t tag_bits;
     /** List of registered xproperties */
     xproperty_array_t xproperties;
     /* xkb context */
@@ -199,6 +221,76 @@ typedef struct
     xcb_generic_event_t *pending_event;
     /** The exit code that main() will return with */
     int exit_code;
+    /** Counters for the test suite and benchmarks, see awesome.stats() */
+    struct
+    {
+        /** Number of calls to awesome_refresh() */
+        unsigned int refresh;
+        /** Number of drawins that got their geometry applied */
+        unsigned int refresh_drawins;
+        /** Number of clients that got their geometry applied */
+        unsigned int refresh_clients;
+        /** Number of windows that got their border applied */
+        unsigned int refresh_borders;
+        /** Number of times the stacking order was recomputed */
+        unsigned int stack_refresh;
+        /** Number of restacking requests sent to the X server */
+        unsigned int stack_requests;
+        /** Number of restacking requests sent by the last stack refresh */
+        unsigned int stack_last_requests;
+        /** Number of EWMH root window properties that were written */
+        unsigned int ewmh_updates;
+        /** Number of EWMH root window property writes skipped as unchanged */
+        unsigned int ewmh_skipped;
+        /** Number of times banning was recomputed */
+        unsigned int banning_refresh;
+        /** Number of clients whose banning was checked */
+        unsigned int banning_clients;
+        /** Number of clients whose banning was checked by the last refresh */
+        unsigned int banning_last_clients;
+        /** Number of windows adopted when starting */
+        unsigned int startup_windows;
+        /** Time it took to adopt them, in microseconds */
+        int64_t startup_scan_usec;
+        /** Number of distinct client icons */
+        unsigned int icons;
+        /** Number of references from clients to these icons */
+        unsigned int icon_references;
+        /** Memory used by the raw data of icons */
+        size_t icon_raw_bytes;
+        /** Number of icons that were decoded into a surface */
+        unsigned int icon_decoded;
+        /** Memory used by the decoded icons */
+        size_t icon_decoded_bytes;
+        /** Number of times the wallpaper was set */
+        unsigned int wallpaper_updates;
+        /** Number of times a new wallpaper pixmap had to be created */
+        unsigned int wallpaper_full;
+        /** Number of wallpaper pixels that were repainted */
+        uint64_t wallpaper_pixels;
+        /** Number of drawable pixmaps taken from the pool */
+        unsigned int pixmap_hits;
+        /** Number of drawable pixmaps that had to be created */
+        unsigned int pixmap_misses;
+        /** Number of unused pixmaps freed because of the pool limit */
+        unsigned int pixmap_evictions;
+        /** Memory used by the unused pixmaps in the pool */
+        size_t pixmap_pool_bytes;
+        /** Number of rectangles copied from drawables to the screen */
+        unsigned int drawable_copies;
+        /** Number of bytes copied from drawables to the screen */
+        uint64_t drawable_copy_bytes;
+        /** Number of images loaded from the cache of decoded images */
+        unsigned int image_cache_hits;
+        /** Number of images that had to be decoded */
+        unsigned int image_cache_misses;
+        /** Number of decoded images dropped because of the memory budget */
+        unsigned int image_cache_evictions;
+        /** Number of decoded images in the cache */
+        unsigned int image_cache_count;
+        /** Memory used by the decoded images in the cache */
+        size_t image_cache_bytes;
+    } stats;
 } awesome_t;
 
 extern awesome_t globalconf;
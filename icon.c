@@ -0,0 +1,169 @@
+/*
+ * icon.c - shared client icons
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "icon.h"
+#include "draw.h"
+#include "globalconf.h"
+
+#include <glib.h>
+
+/** All icons with raw data, to share them between clients */
+static GHashTable *icons;
+
+static guint
+icon_hash(gconstpointer key)
+{
+    return ((const icon_t *) key)->hash;
+}
+
+static gboolean
+icon_equal(gconstpointer a, gconstpointer b)
+{
+    const icon_t *ia = a, *ib = b;
+
+    return ia->hash == ib->hash
+        && ia->width == ib->width
+        && ia->height == ib->height
+        && memcmp(ia->data, ib->data, sizeof(*ia->data) * ia->width * ia->height) == 0;
+}
+
+/** FNV-1a hash of the size and the data of an icon */
+static unsigned int
+icon_hash_data(int width, int height, const uint32_t *data)
+{
+    uint32_t hash = 2166136261u;
+    size_t len = (size_t) width * height;
+
+    hash = (hash ^ width) * 16777619u;
+    hash = (hash ^ height) * 16777619u;
+    for(size_t i = 0; i < len; i++)
+        hash = (hash ^ data[i]) * 16777619u;
+
+    return hash;
+}
+
+/** Get an icon for some _NET_WM_ICON data.
+ * If an icon with the same data already exists, it is shared.
+ * \param width The width of the icon.
+ * \param height The height of the icon.
+ * \param data The ARGB data, not premultiplied. It is copied if needed.
+ * \return A new reference to the icon.
+ */
+icon_t *
+icon_new_from_data(int width, int height, const uint32_t *data)
+{
+    icon_t key = {
+        .hash = icon_hash_data(width, height, data),
+        .width = width,
+        .height = height,
+        .data = (uint32_t *) data
+    };
+    icon_t *icon;
+
+    if(!icons)
+        icons = g_hash_table_new(icon_hash, icon_equal);
+    else if((icon = g_hash_table_lookup(icons, &key)))
+    {
+        icon->refcount++;
+        globalconf.stats.icon_references++;
+        return icon;
+    }
+
+    icon = p_dup(&key, 1);
+    icon->refcount = 1;
+    icon->data = p_dup(data, (size_t) width * height);
+    g_hash_table_add(icons, icon);
+
+    globalconf.stats.icons++;
+    globalconf.stats.icon_references++;
+    globalconf.stats.icon_raw_bytes += sizeof(*data) * width * height;
+
+    return icon;
+}
+
+/** Get an icon for an already decoded surface.
+ * \param surface An image surface, the icon takes over this reference.
+ * \return A new reference to the icon.
+ */
+icon_t *
+icon_new_from_surface(cairo_surface_t *surface)
+{
+    icon_t *icon = p_new(icon_t, 1);
+
+    icon->refcount = 1;
+    icon->width = cairo_image_surface_get_width(surface);
+    icon->height = cairo_image_surface_get_height(surface);
+    icon->surface = surface;
+
+    globalconf.stats.icons++;
+    globalconf.stats.icon_references++;
+    globalconf.stats.icon_decoded++;
+    globalconf.stats.icon_decoded_bytes +=
+        cairo_image_surface_get_stride(surface) * icon->height;
+
+    return icon;
+}
+
+/** Drop a reference to an icon.
+ * \param icon The icon.
+ */
+void
+icon_unref(icon_t **icon)
+{
+    icon_t *i = *icon;
+
+    globalconf.stats.icon_references--;
+    if(--i->refcount > 0)
+        return;
+
+    globalconf.stats.icons--;
+    if(i->data)
+    {
+        g_hash_table_remove(icons, i);
+        globalconf.stats.icon_raw_bytes -= sizeof(*i->data) * i->width * i->height;
+        p_delete(&i->data);
+    }
+    if(i->surface)
+    {
+        globalconf.stats.icon_decoded--;
+        globalconf.stats.icon_decoded_bytes -=
+            cairo_image_surface_get_stride(i->surface) * i->height;
+        cairo_surface_destroy(i->surface);
+    }
+    p_delete(icon);
+}
+
+/** Get the surface of an icon, decoding it if this was not done yet.
+ * \param icon The icon.
+ * \return The surface, owned by the icon.
+ */
+cairo_surface_t *
+icon_get_surface(icon_t *icon)
+{
+    if(!icon->surface)
+    {
+        icon->surface = draw_surface_from_data(icon->width, icon->height, icon->data);
+        globalconf.stats.icon_decoded++;
+        globalconf.stats.icon_decoded_bytes +=
+            cairo_image_surface_get_stride(icon->surface) * icon->height;
+    }
+    return icon->surface;
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
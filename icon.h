@@ -0,0 +1,55 @@
+/*
+ * icon.h - shared client icons header
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AWESOME_ICON_H
+#define AWESOME_ICON_H
+
+#include <cairo.h>
+#include <stdint.h>
+
+#include "common/array.h"
+
+/** An icon of a client in a single size.
+ * Icons from _NET_WM_ICON keep their raw ARGB data and are only turned into a
+ * cairo surface when somebody asks for it. They are shared between all
+ * clients with the same icon data.
+ */
+typedef struct icon_t
+{
+    /** Number of references to this icon */
+    int refcount;
+    /** Hash of the raw data, valid if data is not NULL */
+    unsigned int hash;
+    /** Size of the icon */
+    int width, height;
+    /** Raw ARGB data, not premultiplied, or NULL */
+    uint32_t *data;
+    /** The decoded icon, or NULL if not decoded yet */
+    cairo_surface_t *surface;
+} icon_t;
+
+icon_t *icon_new_from_data(int, int, const uint32_t *);
+icon_t *icon_new_from_surface(cairo_surface_t *);
+void icon_unref(icon_t **);
+cairo_surface_t *icon_get_surface(icon_t *);
+
+DO_ARRAY(icon_t *, icon, icon_unref)
+
+#endif
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
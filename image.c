@@ -0,0 +1,215 @@
+/*
+ * image.c - cache of decoded images
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Theme icons, titlebar buttons and layout icons are loaded again whenever the
+ * Lua side lost its copy to the garbage collector. Decoding them is much more
+ * expensive than copying their pixels, so decoded images are kept here, keyed
+ * by their path and checked against the modification time and size of the
+ * file. The least recently used images are dropped when the cache grows
+ * beyond its memory budget.
+ */
+
+#include "image.h"
+#include "draw.h"
+#include "globalconf.h"
+
+#include <sys/stat.h>
+
+/** The default memory budget of the decoded images */
+#define IMAGE_CACHE_DEFAULT_LIMIT (32 * 1024 * 1024)
+
+typedef struct
+{
+    /** The path the image was loaded from */
+    char *path;
+    /** Inode, modification time and size of the file when it was loaded */
+    ino_t inode;
+    struct timespec mtime;
+    off_t size;
+    /** The decoded image */
+    cairo_surface_t *surface;
+    /** Memory used by the decoded image */
+    size_t bytes;
+    /** The position in the list of entries */
+    GList *link;
+} image_entry_t;
+
+/** Cached images, indexed by their path */
+static GHashTable *images;
+/** Cached images, the least recently used one first */
+static GQueue lru = G_QUEUE_INIT;
+static size_t cache_limit = IMAGE_CACHE_DEFAULT_LIMIT;
+
+static void
+image_entry_delete(image_entry_t *entry)
+{
+    g_queue_delete_link(&lru, entry->link);
+    g_hash_table_remove(images, entry->path);
+    globalconf.stats.image_cache_bytes -= entry->bytes;
+    globalconf.stats.image_cache_count--;
+    cairo_surface_destroy(entry->surface);
+    p_delete(&entry->path);
+    p_delete(&entry);
+}
+
+/** Drop the least recently used images until the cache fits into its budget.
+ */
+static void
+image_cache_trim(void)
+{
+    while(globalconf.stats.image_cache_bytes > cache_limit)
+    {
+        image_entry_delete(g_queue_peek_head(&lru));
+        globalconf.stats.image_cache_evictions++;
+    }
+}
+
+/** Copy a decoded image, keeping its format.
+ * \param surface The image to copy.
+ * \return A new image with the same content.
+ */
+static cairo_surface_t *
+image_copy(cairo_surface_t *surface)
+{
+    cairo_format_t format = cairo_image_surface_get_format(surface);
+    int width = cairo_image_surface_get_width(surface);
+    int height = cairo_image_surface_get_height(surface);
+    cairo_surface_t *copy = cairo_image_surface_create(format, width, height);
+    int stride = cairo_image_surface_get_stride(surface);
+    int copy_stride = cairo_image_surface_get_stride(copy);
+    const unsigned char *src = cairo_image_surface_get_data(surface);
+    unsigned char *dst = cairo_image_surface_get_data(copy);
+
+    if(cairo_surface_status(copy) != CAIRO_STATUS_SUCCESS)
+        return copy;
+
+    cairo_surface_flush(surface);
+    cairo_surface_flush(copy);
+    for(int y = 0; y < height; y++)
+        memcpy(dst + (size_t) y * copy_stride, src + (size_t) y * stride,
+               MIN(stride, copy_stride));
+    cairo_surface_mark_dirty(copy);
+
+    return copy;
+}
+
+/** Check if a file was changed since it was loaded into the cache.
+ * \param entry The cached image.
+ * \param st The current status of the file.
+ * \return true if the cached image is still valid.
+ */
+static bool
+image_entry_is_current(const image_entry_t *entry, const struct stat *st)
+{
+    /* The inode changes when the file is replaced by a rename */
+    return entry->inode == st->st_ino
+        && entry->mtime.tv_sec == st->st_mtim.tv_sec
+        && entry->mtime.tv_nsec == st->st_mtim.tv_nsec
+        && entry->size == st->st_size;
+}
+
+/** Load an image, decoding it only if it is not in the cache yet.
+ * \param L The Lua VM state.
+ * \param path The file to load.
+ * \param shared If true, the cached image itself is returned and must not be
+ * modified. Otherwise, the caller gets its own copy.
+ * \param error A place to store an error message, if needed.
+ * \return A new reference to an image, or NULL on error.
+ */
+cairo_surface_t *
+image_cache_load(lua_State *L, const char *path, bool shared, GError **error)
+{
+    struct stat st;
+    image_entry_t *entry;
+
+    /* Let the image loader report missing files */
+    if(stat(path, &st) != 0)
+        return draw_load_image(L, path, error);
+
+    if(!images)
+        images = g_hash_table_new(g_str_hash, g_str_equal);
+
+    entry = g_hash_table_lookup(images, path);
+    if(entry && !image_entry_is_current(entry, &st))
+    {
+        image_entry_delete(entry);
+        entry = NULL;
+    }
+
+    if(entry)
+    {
+        globalconf.stats.image_cache_hits++;
+        g_queue_unlink(&lru, entry->link);
+        g_queue_push_tail_link(&lru, entry->link);
+    }
+    else
+    {
+        cairo_surface_t *surface = draw_load_image(L, path, error);
+        size_t bytes;
+
+        globalconf.stats.image_cache_misses++;
+        if(!surface)
+            return NULL;
+
+        bytes = (size_t) cairo_image_surface_get_stride(surface)
+            * cairo_image_surface_get_height(surface);
+        if(bytes > cache_limit)
+            return surface;
+
+        entry = p_new(image_entry_t, 1);
+        entry->path = a_strdup(path);
+        entry->inode = st.st_ino;
+        entry->mtime = st.st_mtim;
+        entry->size = st.st_size;
+        entry->surface = surface;
+        entry->bytes = bytes;
+        g_queue_push_tail(&lru, entry);
+        entry->link = g_queue_peek_tail_link(&lru);
+        g_hash_table_insert(images, entry->path, entry);
+        globalconf.stats.image_cache_bytes += bytes;
+        globalconf.stats.image_cache_count++;
+
+        /* The new image is the most recently used one and fits, so it stays */
+        image_cache_trim();
+    }
+
+    if(shared)
+        return cairo_surface_reference(entry->surface);
+    return image_copy(entry->surface);
+}
+
+/** Set the memory budget of the cached images.
+ * \param limit The budget in bytes, 0 disables the cache.
+ */
+void
+image_cache_set_limit(size_t limit)
+{
+    cache_limit = limit;
+    image_cache_trim();
+}
+
+/** Drop all cached images. */
+void
+image_cache_purge(void)
+{
+    while(!g_queue_is_empty(&lru))
+        image_entry_delete(g_queue_peek_head(&lru));
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
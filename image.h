@@ -0,0 +1,34 @@
+/*
+ * image.h - cache of decoded images header
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AWESOME_IMAGE_H
+#define AWESOME_IMAGE_H
+
+#include <cairo.h>
+#include <glib.h>
+#include <lua.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+cairo_surface_t *image_cache_load(lua_State *, const char *, bool, GError **);
+void image_cache_set_limit(size_t);
+void image_cache_purge(void);
+
+#endif
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -7,6 +7,8 @@
 -- Grab environment we need
 local type = type
 local ipairs = ipairs
+local setmetatable = setmetatable
+local table = table
 local capi = { button = button }
 local wibox = require("wibox")
 local dpi = require("beautiful").xresources.apply_dpi
@@ -36,7 +38,129 @@ function common.create_buttons(buttons, object)
     end
 end
 
+-- The objects shown by each widget updated by `common.list_update`
+local displayed = setmetatable({}, { __mode = "k" })
+
+-- Entries released by `common.list_release`, waiting for a new object,
+-- indexed by the data table they belong to
+local spare_entries = setmetatable({}, { __mode = "k" })
+
+-- Do not keep more spare entries than this per list
+local max_spare_entries = 16
+
+local function create_entry(buttons, o)
+    local ib = wibox.widget.imagebox()
+    local tb = wibox.widget.textbox()
+    local bgb = wibox.container.background()
+    local tbm = wibox.container.margin(tb, dpi(4), dpi(4))
+    local ibm = wibox.container.margin(ib, dpi(4))
+    local l = wibox.layout.fixed.horizontal()
+
+    -- All of this is added in a fixed widget
+    l:fill_space(true)
+    l:add(ibm)
+    l:add(tbm)
+
+    -- And all of this gets a background
+    bgb:set_widget(l)
+
+    bgb:buttons(common.create_buttons(buttons, o))
+
+    return {
+        ib  = ib,
+        tb  = tb,
+        bgb = bgb,
+        tbm = tbm,
+        ibm = ibm,
+    }
+end
+
+-- Take a spare entry and make it ready to show another object
+local function recycle_entry(data, buttons, o)
+    local spares = spare_entries[data]
+    local cache = spares and table.remove(spares)
+    if not cache then
+        return nil
+    end
+
+    cache.tbm:set_left(dpi(4))
+    cache.tbm:set_right(dpi(4))
+    cache.tbm:set_top(0)
+    cache.tbm:set_bottom(0)
+    cache.ibm:set_left(dpi(4))
+    cache.ibm:set_right(0)
+    cache.ibm:set_top(0)
+    cache.ibm:set_bottom(0)
+    cache.ib:set_image(nil)
+    cache.bgb:buttons(common.create_buttons(buttons, o))
+
+    -- Forget what the entry showed, so that everything is set again
+    cache.label, cache.label_set = nil, nil
+
+    return cache
+end
+
+-- Apply the label of an object to its entry, only touching what changed
+local function update_entry(cache, label, o, objects, i)
+    local tb, tbm, bgb, ib, ibm = cache.tb, cache.tbm, cache.bgb, cache.ib, cache.ibm
+    local text, bg, bg_image, icon, args = label(o, tb)
+    args = args or {}
+
+    local old = cache.label or {}
+    local new = {
+        text               = text,
+        bg                 = bg,
+        bg_image           = bg_image,
+        icon               = icon,
+        shape              = args.shape,
+        shape_border_width = args.shape_border_width,
+        shape_border_color = args.shape_border_color,
+    }
+    cache.label = new
+
+    -- The text might be invalid, so use pcall.
+    if text == nil or text == "" then
+        tbm:set_margins(0)
+    elseif text ~= old.text then
+        if not tb:set_markup_silently(text) then
+            tb:set_markup("<i>&lt;Invalid text&gt;</i>")
+        end
+    end
+    if not cache.label_set or bg ~= old.bg then
+        bgb:set_bg(bg)
+    end
+    if type(bg_image) == "function" then
+        -- TODO: Why does this pass nil as an argument?
+        bg_image = bg_image(tb,o,nil,objects,i)
+        cache.dynamic = true
+    else
+        cache.dynamic = false
+    end
+    if not cache.label_set or cache.dynamic or bg_image ~= old.bg_image then
+        bgb:set_bgimage(bg_image)
+    end
+    if icon then
+        -- Every read of a C surface like c.icon adds a reference that only
+        -- the imagebox takes over, so those are always passed on.
+        if icon ~= old.icon or type(icon) == "userdata" then
+            ib:set_image(icon)
+        end
+    else
+        ibm:set_margins(0)
+    end
+
+    bgb.shape              = args.shape
+    bgb.shape_border_width = args.shape_border_width
+    bgb.shape_border_color = args.shape_border_color
+    cache.label_set = true
+end
+
 --- Common update method.
+--
+-- The widgets of the objects are kept in `data` and reused by later updates.
+-- When the objects are shown in the same order as before, the content of `w`
+-- is not touched at all.
+--
 -- @param w The widget.
 -- @tab buttons
 -- @func label Function to generate label parameters from an object.
@@ -44,74 +168,77 @@ end
 --   has to return `text`, `bg`, `bg_image`, `icon`.
 -- @tab data Current data/cache, indexed by objects.
 -- @tab objects Objects to be displayed / updated.
-function common.list_update(w, buttons, label, data, objects)
+-- @tab[opt] changed A set of the objects whose label may have changed since
+--   the last update. Without it, all labels are generated again.
+function common.list_update(w, buttons, label, data, objects, changed)
+    local state = displayed[w]
+    local same_order = state ~= nil and #state.objects == #objects
+        and w.get_children ~= nil and w:get_children() == state.children
+        and #state.children == #objects
+
     -- update the widgets, creating them if needed
-    w:reset()
     for i, o in ipairs(objects) do
         local cache = data[o]
-        local ib, tb, bgb, tbm, ibm, l
-        if cache then
-            ib = cache.ib
-            tb = cache.tb
-            bgb = cache.bgb
-            tbm = cache.tbm
-            ibm = cache.ibm
-        else
-            ib = wibox.widget.imagebox()
-            tb = wibox.widget.textbox()
-            bgb = wibox.container.background()
-            tbm = wibox.container.margin(tb, dpi(4), dpi(4))
-            ibm = wibox.container.margin(ib, dpi(4))
-            l = wibox.layout.fixed.horizontal()
-
-            -- All of this is added in a fixed widget
-            l:fill_space(true)
-            l:add(ibm)
-            l:add(tbm)
-
-            -- And all of this gets a background
-            bgb:set_widget(l)
-
-            bgb:buttons(common.create_buttons(buttons, o))
-
-            data[o] = {
-                ib  = ib,
-                tb  = tb,
-                bgb = bgb,
-                tbm = tbm,
-                ibm = ibm,
-            }
+        if not cache then
+            cache = recycle_entry(data, buttons, o) or create_entry(buttons, o)
+            data[o] = cache
         end
 
-        local text, bg, bg_image, icon, args = label(o, tb)
-        args = args or {}
-
-        -- The text might be invalid, so use pcall.
-        if text == nil or text == "" then
-            tbm:set_margins(0)
-        else
-            if not tb:set_markup_silently(text) then
-                tb:set_markup("<i>&lt;Invalid text&gt;</i>")
-            end
+        -- Objects that were not shown may have changed meanwhile
+        if not cache.label_set or not changed or changed[o] or cache.dynamic
+            or not (state and state.shown[o]) then
+            update_entry(cache, label, o, objects, i)
         end
-        bgb:set_bg(bg)
-        if type(bg_image) == "function" then
-            -- TODO: Why does this pass nil as an argument?
-            bg_image = bg_image(tb,o,nil,objects,i)
+
+        if same_order and state.objects[i] ~= o then
+            same_order = false
         end
-        bgb:set_bgimage(bg_image)
-        if icon then
-            ib:set_image(icon)
-        else
-            ibm:set_margins(0)
+    end
+
+    if same_order then
+        return
+    end
+
+    local widgets, shown = {}, setmetatable({}, { __mode = "k" })
+    for i, o in ipairs(objects) do
+        widgets[i] = data[o].bgb
+        shown[o] = true
+    end
+    if w.set_children then
+        w:set_children(widgets)
+    else
+        w:reset()
+        for _, bgb in ipairs(widgets) do
+            w:add(bgb)
         end
+    end
+
+    displayed[w] = {
+        objects  = objects,
+        shown    = shown,
+        children = w.get_children and w:get_children(),
+    }
+end
 
-        bgb.shape              = args.shape
-        bgb.shape_border_width = args.shape_border_width
-        bgb.shape_border_color = args.shape_border_color
+--- Release the widgets of an object that will not be shown anymore, so that
+-- `common.list_update` can reuse them for another object.
+-- @tab data The data/cache given to `common.list_update`.
+-- @param object The object to release.
+function common.list_release(data, object)
+    local cache = data[object]
+    data[object] = nil
+    if not cache or not cache.bgb then
+        return
+    end
 
-        w:add(bgb)
-   end
+    local spares = spare_entries[data]
+    if not spares then
+        spares = {}
+        spare_entries[data] = spares
+    end
+    if #spares < max_spare_entries then
+        table.insert(spares, cache)
+    end
 end
 
 return common
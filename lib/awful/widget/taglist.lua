@@ -351,7 +351,7 @@ function taglist.taglist_label(t, args)
     return text, bg_color, bg_image, not taglist_disable_icon and icon or nil, other_args
 end
 
-local function taglist_update(s, w, buttons, filter, data, style, update_function)
+local function taglist_update(s, w, buttons, filter, data, style, update_function, changed)
     local tags = {}
     for _, t in ipairs(s.tags) do
         if not tag.getproperty(t, "hide") and filter(t) then
@@ -361,7 +361,7 @@ local function taglist_update(s, w, buttons, filter, data, style, update_functio
 
     local function label(c) return taglist.taglist_label(c, style) end
 
-    update_function(w, buttons, label, data, tags)
+    update_function(w, buttons, label, data, tags, changed)
 end
 
 --- Create a new taglist widget. The last two arguments (update_function
@@ -418,13 +418,25 @@ function taglist.new(screen, filter, buttons, style, update_function, base_widge
 
     local data = setmetatable({}, { __mode = 'k' })
 
+    -- The tags whose label may have changed since the last update, or nil if
+    -- all of them may have
+    local changed = setmetatable({}, { __mode = 'k' })
+
     local queued_update = {}
-    function w._do_taglist_update()
+    function w._do_taglist_update(t)
+        if not t then
+            changed = nil
+        elseif changed then
+            changed[t] = true
+        end
+
         -- Add a delayed callback for the first update.
         if not queued_update[screen] then
             timer.delayed_call(function()
+                local update_changed = changed
+                changed = setmetatable({}, { __mode = 'k' })
                 if screen.valid then
-                    taglist_update(screen, w, buttons, filter, data, style, uf)
+                    taglist_update(screen, w, buttons, filter, data, style, uf, update_changed)
                 end
                 queued_update[screen] = false
             end)
@@ -433,18 +445,25 @@ function taglist.new(screen, filter, buttons, style, update_function, base_widge
     end
     if instances == nil then
         instances = setmetatable({}, { __mode = "k" })
-        local function u(s)
+        -- Update the taglists of a screen, for a change of `t` or of all tags
+        local function u(s, t)
             local i = instances[get_screen(s)]
             if i then
                 for _, tlist in pairs(i) do
-                    tlist._do_taglist_update()
+                    tlist._do_taglist_update(t)
                 end
             end
         end
         local uc = function (c) return u(c.screen) end
-        local ut = function (t) return u(t.screen) end
-        capi.client.connect_signal("focus", uc)
-        capi.client.connect_signal("unfocus", uc)
+        local ut = function (t) return u(t.screen, t) end
+        -- Only the tags of the client show whether it is focused
+        local ufocus = function (c)
+            for _, t in ipairs(c:tags()) do
+                u(c.screen, t)
+            end
+        end
+        capi.client.connect_signal("focus", ufocus)
+        capi.client.connect_signal("unfocus", ufocus)
         tag.attached_connect_signal(nil, "property::selected", ut)
         tag.attached_connect_signal(nil, "property::icon", ut)
         tag.attached_connect_signal(nil, "property::hide", ut)
@@ -457,8 +476,8 @@ function taglist.new(screen, filter, buttons, style, update_function, base_widge
             u(c.screen)
             u(old_screen)
         end)
-        capi.client.connect_signal("tagged", uc)
-        capi.client.connect_signal("untagged", uc)
+        capi.client.connect_signal("tagged", function (c, t) return u(c.screen, t) end)
+        capi.client.connect_signal("untagged", function (c, t) return u(c.screen, t) end)
         capi.client.connect_signal("unmanage", uc)
         capi.screen.connect_signal("removed", function(s)
             instances[get_screen(s)] = nil
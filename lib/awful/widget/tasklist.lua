@@ -348,7 +348,7 @@ local function tasklist_label(c, args, tb)
     return text, bg, bg_image, not tasklist_disable_icon and c.icon or nil, other_args
 end
 
-local function tasklist_update(s, w, buttons, filter, data, style, update_function)
+local function tasklist_update(s, w, buttons, filter, data, style, update_function, changed)
     local clients = {}
     for _, c in ipairs(capi.client.get()) do
         if not (c.skip_taskbar or c.hidden
@@ -360,7 +360,7 @@ local function tasklist_update(s, w, buttons, filter, data, style, update_functi
 
     local function label(c, tb) return tasklist_label(c, style, tb) end
 
-    update_function(w, buttons, label, data, clients)
+    update_function(w, buttons, label, data, clients, changed)
 end
 
 --- Create a new tasklist widget. The last two arguments (update_function
@@ -421,42 +421,68 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
         w:set_spacing(style and style.spacing or beautiful.tasklist_spacing)
     end
 
+    -- The clients whose label may have changed since the last update, or
+    -- nil if all of them may have
+    local changed = setmetatable({}, { __mode = 'k' })
+
     local queued_update = false
-    function w._do_tasklist_update()
-        -- Add a delayed callback for the first update.
+    function w._do_tasklist_update(c)
+        if not c then
+            changed = nil
+        elseif changed then
+            changed[c] = true
+        end
+
+        -- Add a delayed callback for the first update. All the changes
+        -- until then are handled at once.
         if not queued_update then
             timer.delayed_call(function()
                 queued_update = false
+                local update_changed = changed
+                changed = setmetatable({}, { __mode = 'k' })
                 if screen.valid then
-                    tasklist_update(screen, w, buttons, filter, data, style, uf)
+                    tasklist_update(screen, w, buttons, filter, data, style, uf, update_changed)
                 end
             end)
             queued_update = true
         end
     end
     function w._unmanage(c)
-        data[c] = nil
+        common.list_release(data, c)
     end
     if instances == nil then
         instances = setmetatable({}, { __mode = "k" })
-        local function us(s)
+        local function us(s, c)
             local i = instances[get_screen(s)]
             if i then
                 for _, tlist in pairs(i) do
-                    tlist._do_tasklist_update()
+                    tlist._do_tasklist_update(c)
                 end
             end
         end
-        local function u()
+        -- Update all tasklists, for a change of `c` or of everything
+        local function u(c)
             for s in pairs(instances) do
                 if s.valid then
-                    us(s)
+                    us(s, c)
                 end
             end
         end
+        local function uall()
+            u()
+        end
+        -- The label of a client depends on whether its transients that skip
+        -- the taskbar are focused.
+        local function ufocus(c)
+            if c.skip_taskbar then
+                u()
+            else
+                u(c)
+            end
+        end
 
-        tag.attached_connect_signal(nil, "property::selected", u)
-        tag.attached_connect_signal(nil, "property::activated", u)
+        tag.attached_connect_signal(nil, "property::selected", uall)
+        tag.attached_connect_signal(nil, "property::activated", uall)
         capi.client.connect_signal("property::urgent", u)
         capi.client.connect_signal("property::sticky", u)
         capi.client.connect_signal("property::ontop", u)
@@ -470,10 +496,10 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
         capi.client.connect_signal("property::name", u)
         capi.client.connect_signal("property::icon_name", u)
         capi.client.connect_signal("property::icon", u)
-        capi.client.connect_signal("property::skip_taskbar", u)
+        capi.client.connect_signal("property::skip_taskbar", uall)
         capi.client.connect_signal("property::screen", function(c, old_screen)
-            us(c.screen)
-            us(old_screen)
+            us(c.screen, c)
+            us(old_screen, c)
         end)
         capi.client.connect_signal("property::hidden", u)
         capi.client.connect_signal("tagged", u)
@@ -486,9 +512,9 @@ function tasklist.new(screen, filter, buttons, style, update_function, base_widg
                 end
             end
         end)
-        capi.client.connect_signal("list", u)
-        capi.client.connect_signal("focus", u)
-        capi.client.connect_signal("unfocus", u)
+        capi.client.connect_signal("list", uall)
+        capi.client.connect_signal("focus", ufocus)
+        capi.client.connect_signal("unfocus", ufocus)
         capi.screen.connect_signal("removed", function(s)
             instances[get_screen(s)] = nil
         end)
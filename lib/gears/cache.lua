@@ -6,44 +6,194 @@
 
 local select = select
 local setmetatable = setmetatable
+local next = next
 local unpack = unpack or table.unpack -- luacheck: globals unpack (compatibility with Lua 5.1)
+local GLib = require("lgi").GLib
 
 local cache = {}
 
+local function now()
+    return GLib.get_monotonic_time() / 1000000
+end
+
+-- {{{ Bounded caches
+
+-- The entries of a bounded cache are kept in a doubly linked list, the most
+-- recently used one first.
+
+local function lru_unlink(self, entry)
+    if entry._prev then
+        entry._prev._next = entry._next
+    else
+        self._head = entry._next
+    end
+    if entry._next then
+        entry._next._prev = entry._prev
+    else
+        self._tail = entry._prev
+    end
+    entry._prev, entry._next = nil, nil
+end
+
+local function lru_push(self, entry)
+    entry._next = self._head
+    if self._head then
+        self._head._prev = entry
+    else
+        self._tail = entry
+    end
+    self._head = entry
+end
+
+-- Stop accounting for an entry
+local function lru_drop(self, entry)
+    lru_unlink(self, entry)
+    self._size = self._size - 1
+    self._cost = self._cost - entry._cost
+    self._evictions = self._evictions + 1
+end
+
+-- Remove an entry from the cache, together with the tables on its path that
+-- became empty.
+local function lru_remove(self, entry)
+    lru_drop(self, entry)
+
+    local nodes = { self._cache }
+    local args = entry._args
+    for i = 1, args.n do
+        nodes[i + 1] = nodes[i][args[i]]
+    end
+    nodes[args.n + 1]._entry = nil
+    for i = args.n, 1, -1 do
+        if next(nodes[i + 1]) ~= nil then
+            break
+        end
+        nodes[i][args[i]] = nil
+    end
+end
+
+local function lru_add(self, entry, ...)
+    entry._args = { n = select("#", ...), ... }
+    entry._cost = self._cost_cb and self._cost_cb(unpack(entry)) or 1
+    if self._ttl then
+        entry._expires = now() + self._ttl
+    end
+    lru_push(self, entry)
+    self._size = self._size + 1
+    self._cost = self._cost + entry._cost
+
+    -- Make room, but always keep the new entry
+    local max_size, max_cost = self._max_size, self._max_cost
+    while self._tail ~= entry and ((max_size and self._size > max_size)
+            or (max_cost and self._cost > max_cost)) do
+        lru_remove(self, self._tail)
+    end
+end
+
+-- }}}
+
+-- Get the table holding the entry for the given arguments
+local function find_node(result, ...)
+    for i = 1, select("#", ...) do
+        local arg = select(i, ...)
+        local next_result = result[arg]
+        if not next_result then
+            next_result = {}
+            result[arg] = next_result
+        end
+        result = next_result
+    end
+    return result
+end
+
 --- Get an entry from the cache, creating it if it's missing.
 -- @param ... Arguments for the creation callback. These are checked against the
 --   cache contents for equality.
 -- @return The entry from the cache
 function cache:get(...)
-    local result = self._cache
-    for i = 1, select("#", ...) do
-        local arg = select(i, ...)
-        local next = result[arg]
-        if not next then
-            next = {}
-            result[arg] = next
+    local result = find_node(self._cache, ...)
+    local ret = result._entry
+    if ret and self._bounded then
+        if ret._expires and ret._expires <= now() then
+            lru_drop(self, ret)
+            result._entry = nil
+            ret = nil
+        else
+            lru_unlink(self, ret)
+            lru_push(self, ret)
         end
-        result = next
     end
-    local ret = result._entry
-    if not ret then
-        ret = { self._creation_cb(...) }
+    if ret then
+        self._hits = self._hits + 1
+        return unpack(ret)
+    end
+
+    self._misses = self._misses + 1
+    ret = { self._creation_cb(...) }
+    if self._bounded then
+        -- The callback could have used this cache and evicted the path
+        result = find_node(self._cache, ...)
+        if result._entry then
+            return unpack(result._entry)
+        end
+        result._entry = ret
+        lru_add(self, ret, ...)
+    else
         result._entry = ret
     end
     return unpack(ret)
 end
 
+--- Get statistics about the use of this cache.
+-- The number of entries and their total cost are only tracked by bounded
+-- caches, evictions by the garbage collector are not counted.
+-- @treturn table A table with the `hits`, `misses`, `evictions`, `size` and
+--   `cost` keys.
+function cache:get_stats()
+    return {
+        hits      = self._hits,
+        misses    = self._misses,
+        evictions = self._evictions,
+        size      = self._size,
+        cost      = self._cost,
+    }
+end
+
 --- Create a new cache object. A cache keeps some data that can be
 -- garbage-collected at any time, but might be useful to keep.
+--
+-- When `args` is given, the entries are instead kept until they are evicted
+-- to respect the given bounds, the least recently used ones first.
 -- @param creation_cb Callback that is used for creating missing cache entries.
+-- @tparam[opt] table args Bounds for the cache.
+-- @tparam[opt] number args.max_size The maximum number of entries.
+-- @tparam[opt] number args.max_cost The maximum total cost of the entries.
+-- @tparam[opt] function args.cost Callback computing the cost of an entry
+--   from the values returned by `creation_cb`. Each entry costs 1 by default.
+-- @tparam[opt] number args.ttl The number of seconds after which an entry is
+--   created again.
 -- @return A new cache object.
-function cache.new(creation_cb)
-    return setmetatable({
+function cache.new(creation_cb, args)
+    local ret = setmetatable({
         _cache = setmetatable({}, { __mode = "v" }),
-        _creation_cb = creation_cb
+        _creation_cb = creation_cb,
+        _hits = 0,
+        _misses = 0,
+        _evictions = 0,
     }, {
         __index = cache
     })
+    if args then
+        ret._cache = {}
+        ret._bounded = true
+        ret._max_size = args.max_size
+        ret._max_cost = args.max_cost
+        ret._cost_cb = args.cost
+        ret._ttl = args.ttl
+        ret._size = 0
+        ret._cost = 0
+    end
+    return ret
 end
 
 return setmetatable(cache, { __call = function(_, ...) return cache.new(...) end })
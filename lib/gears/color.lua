@@ -345,7 +345,9 @@ function color.mt.__call(_, ...)
     return color.create_pattern(...)
 end
 
-pattern_cache = require("gears.cache").new(color.create_pattern_uncached)
+-- Patterns are kept across garbage collections, so that redrawing does not
+-- keep parsing the same colors again.
+pattern_cache = require("gears.cache").new(color.create_pattern_uncached, { max_size = 256 })
 
 --- No color
 color.transparent = color.create_pattern("#00000000")
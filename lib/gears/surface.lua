@@ -28,14 +28,9 @@ local function get_default(arg)
     return arg
 end
 
---- Try to convert the argument into an lgi cairo surface.
--- This is usually needed for loading images by file name.
--- @param _surface The surface to load or nil
--- @param default The default value to return on error; when nil, then a surface
--- in an error state is returned.
--- @return The loaded surface, or the replacement default
--- @return An error message, or nil on success
-function surface.load_uncached_silently(_surface, default)
+-- Load an image, `shared` tells if the decoded image that awesome keeps in its
+-- cache can be returned instead of a copy of it.
+local function load_silently(_surface, default, shared)
     local file
     -- On nil, return some sane default
     if not _surface then
@@ -49,7 +44,7 @@ function surface.load_uncached_silently(_surface, default)
     if type(_surface) == "string" then
         local err
         file = _surface
-        _surface, err = capi.awesome.load_image(file)
+        _surface, err = capi.awesome.load_image(file, shared)
         if not _surface then
             return get_default(default), err
         end
@@ -58,6 +53,17 @@ function surface.load_uncached_silently(_surface, default)
     return cairo.Surface(_surface, true)
 end
 
+--- Try to convert the argument into an lgi cairo surface.
+-- This is usually needed for loading images by file name.
+-- @param _surface The surface to load or nil
+-- @param default The default value to return on error; when nil, then a surface
+-- in an error state is returned.
+-- @return The loaded surface, or the replacement default
+-- @return An error message, or nil on success
+function surface.load_uncached_silently(_surface, default)
+    return load_silently(_surface, default, false)
+end
+
 --- Try to convert the argument into an lgi cairo surface.
 -- This is usually needed for loading images by file name and uses a cache.
 -- In contrast to `load()`, errors are returned to the caller.
@@ -73,7 +79,8 @@ function surface.load_silently(_surface, default)
         if cache then
             return cache
         end
-        local result, err = surface.load_uncached_silently(_surface, default)
+        -- The result is shared through surface_cache anyway
+        local result, err = load_silently(_surface, default, true)
         if not err then
             -- Cache the file
             surface_cache[_surface] = result
@@ -38,16 +38,19 @@ function wallpaper.prepare_context(s)
     local geom = s and s.geometry or root_geometry()
     local source, target, cr
 
+    local areas = pending_wallpaper and pending_wallpaper.areas or {}
+
     if not pending_wallpaper then
-        -- Prepare a pending wallpaper
-        source = surface(root.wallpaper())
-        target = source:create_similar(cairo.Content.COLOR, root_width, root_height)
+        -- Prepare a pending wallpaper. Only the areas that are drawn to are
+        -- used, so the old wallpaper does not need to be copied.
+        target = surface(root.wallpaper()):create_similar(cairo.Content.COLOR,
+            root_width, root_height)
 
         -- Set the wallpaper (delayed)
         timer.delayed_call(function()
             local paper = pending_wallpaper
             pending_wallpaper = nil
-            wallpaper.set(paper.surface)
+            wallpaper.set(paper.surface, paper.areas)
             paper.surface:finish()
         end)
     elseif root_width > pending_wallpaper.width or root_height > pending_wallpaper.height then
@@ -71,10 +74,12 @@ function wallpaper.prepare_context(s)
         cr:restore()
     end
 
+    table.insert(areas, geom)
     pending_wallpaper = {
         surface = target,
         width = root_width,
-        height = root_height
+        height = root_height,
+        areas = areas
     }
 
     -- Only draw to the selected area
@@ -88,8 +93,10 @@ end
 --- Set the current wallpaper.
 -- @param pattern The wallpaper that should be set. This can be a cairo surface,
 --   a description for gears.color or a cairo pattern.
+-- @tparam[opt] table areas The list of geometries that should be updated. The
+--   rest of the wallpaper is kept. Everything is updated if this is not given.
 -- @see gears.color
-function wallpaper.set(pattern)
+function wallpaper.set(pattern, areas)
     if cairo.Surface:is_type_of(pattern) then
         pattern = cairo.Pattern.create_for_surface(pattern)
     end
@@ -99,7 +106,7 @@ function wallpaper.set(pattern)
     if not cairo.Pattern:is_type_of(pattern) then
         error("wallpaper.set() called with an invalid argument")
     end
-    root.wallpaper(pattern._native)
+    root.wallpaper(pattern._native, areas)
 end
 
 --- Set a centered wallpaper.
@@ -0,0 +1,214 @@
+---------------------------------------------------------------------------
+--- Index of the files in icon directories for menubar
+--
+-- Looking up an icon checks many candidate files in many directories. Instead
+-- of asking the file system about each of them, the content of every
+-- directory is listed once and kept in memory. The listings are also saved to
+-- a cache file together with the modification time of their directory, so
+-- that the next start only has to check the directories themselves.
+--
+-- @module menubar.icon_index
+---------------------------------------------------------------------------
+
+local gfs = require("gears.filesystem")
+local Gio = require("lgi").Gio
+
+local io = io
+local os = os
+local pairs = pairs
+local tonumber = tonumber
+
+local icon_index = {}
+
+--- The file where the listings are saved, or false to not save them.
+-- By default, this is a file in `gears.filesystem.get_cache_dir`.
+icon_index.cache_file = nil
+
+-- The listings used since the last clear(), indexed by directory. Directories
+-- that are missing or not readable are false.
+local listings = {}
+
+-- The listings from the cache file, indexed by directory. Each one has the
+-- modification time of its directory and the set of file names. This is nil
+-- until the cache file was read.
+local saved = nil
+
+-- Whether saved has changes that are not in the cache file yet
+local dirty = false
+
+-- Counts the directories that were listed or taken from the cache file
+local stats = { listed = 0, reused = 0 }
+
+-- Incremented by every clear()
+local generation = 0
+
+local function get_cache_file()
+    if icon_index.cache_file == nil then
+        return gfs.get_cache_dir() .. "menubar-icon-index"
+    end
+    return icon_index.cache_file
+end
+
+-- The cache file has a line with the modification time and the path of each
+-- directory, followed by one line per file name starting with a tab.
+local function load_saved()
+    saved = {}
+    local file = get_cache_file()
+    local f = file and io.open(file, "r")
+    if not f then
+        return
+    end
+
+    local current
+    for line in f:lines() do
+        if line:sub(1, 1) == "\t" then
+            if current then
+                current.names[line:sub(2)] = true
+            end
+        else
+            local mtime, path = line:match("^(%d+)\t(.+)$")
+            current = nil
+            if mtime then
+                current = { mtime = tonumber(mtime), names = {} }
+                saved[path] = current
+            end
+        end
+    end
+    f:close()
+end
+
+-- Get the modification time of a directory in microseconds, or nil if it is
+-- not a readable directory.
+local function get_mtime(path)
+    local info = Gio.File.new_for_path(path):query_info(
+        "standard::type,access::can-read,time::modified,time::modified-usec",
+        Gio.FileQueryInfoFlags.NONE)
+    if not info or info:get_file_type() ~= "DIRECTORY"
+        or not info:get_attribute_boolean("access::can-read") then
+        return nil
+    end
+    return info:get_attribute_uint64("time::modified") * 1000000
+        + info:get_attribute_uint32("time::modified-usec")
+end
+
+-- Get the set of the names of the files in a directory
+local function read_directory(path)
+    local names = {}
+    local enum = Gio.File.new_for_path(path):enumerate_children(
+        "standard::name,standard::type", Gio.FileQueryInfoFlags.NONE)
+    if not enum then
+        return names
+    end
+    while true do
+        local info = enum:next_file()
+        if not info then
+            break
+        end
+        if info:get_file_type() ~= "DIRECTORY" then
+            names[info:get_name()] = true
+        end
+    end
+    enum:close()
+    return names
+end
+
+--- Get the files in a directory.
+-- @tparam string path The directory, without trailing slash.
+-- @treturn table|boolean A set of file names, or false if the directory is
+--   not readable.
+function icon_index.list(path)
+    local names = listings[path]
+    if names ~= nil then
+        return names
+    end
+
+    if not saved then
+        load_saved()
+    end
+
+    local mtime = get_mtime(path)
+    if not mtime then
+        names = false
+        if saved[path] then
+            saved[path] = nil
+            dirty = true
+        end
+    elseif saved[path] and saved[path].mtime == mtime then
+        names = saved[path].names
+        stats.reused = stats.reused + 1
+    else
+        names = read_directory(path)
+        saved[path] = { mtime = mtime, names = names }
+        dirty = true
+        stats.listed = stats.listed + 1
+    end
+
+    listings[path] = names
+    return names
+end
+
+--- Check if a directory contains a file.
+-- @tparam string directory The directory, without trailing slash.
+-- @tparam string name The name of the file.
+-- @treturn boolean True if the file exists.
+function icon_index.file_exists(directory, name)
+    local names = icon_index.list(directory)
+    return names and names[name] or false
+end
+
+--- Forget the listings in memory, so that the directories are checked again.
+-- The next use also reads the cache file again.
+function icon_index.clear()
+    listings = {}
+    saved = nil
+    dirty = false
+    generation = generation + 1
+end
+
+--- Get a number that changes every time the listings are cleared.
+-- This lets users of the listings know when their own caches are outdated.
+-- @treturn number The generation of the listings.
+function icon_index.get_generation()
+    return generation
+end
+
+--- Save the listings to the cache file, if they changed.
+function icon_index.save()
+    local file = get_cache_file()
+    if not dirty or not file then
+        return
+    end
+
+    if icon_index.cache_file == nil then
+        gfs.mkdir(gfs.get_cache_dir())
+    end
+    local tmp = file .. ".tmp"
+    local f = io.open(tmp, "w")
+    if not f then
+        return
+    end
+    for path, entry in pairs(saved) do
+        if not path:find("\n", 1, true) then
+            f:write(string.format("%d\t%s\n", entry.mtime, path))
+            for name in pairs(entry.names) do
+                if not name:find("\n", 1, true) then
+                    f:write("\t", name, "\n")
+                end
+            end
+        end
+    end
+    f:close()
+    os.rename(tmp, file)
+    dirty = false
+end
+
+--- Get statistics about the directories that were checked.
+-- @treturn table A table with the number of directories that had to be
+--   `listed` and of directories whose listing was `reused` from the cache file.
+function icon_index.get_stats()
+    return { listed = stats.listed, reused = stats.reused }
+end
+
+return icon_index
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -14,8 +14,10 @@ local beautiful = require("beautiful")
 local gfs = require("gears.filesystem")
 local GLib = require("lgi").GLib
 local index_theme = require("menubar.index_theme")
+local icon_index = require("menubar.icon_index")
 
 local ipairs = ipairs
+local pairs = pairs
 local setmetatable = setmetatable
 local string = string
 local table = table
@@ -76,6 +78,7 @@ end
 local icon_theme = { mt = {} }
 
 local index_theme_cache = {}
+local icon_map_cache = {}
 
 --- Class constructor of `icon_theme`
 -- @tparam string icon_theme_name Internal name of icon theme
@@ -143,44 +146,82 @@ local directory_size_distance = function(self, subdirectory, icon_size)
     return 0xffffffff -- Any large number will do.
 end
 
-local lookup_icon = function(self, icon_name, icon_size)
-    local checked_already = {}
+-- Get the icons of the theme, indexed by icon name. Each one is a list of the
+-- matching files in the order in which they are looked up, with the
+-- subdirectory that contains them.
+local get_icon_map = function(self)
+    local cache_key = self.icon_theme_name .. "\0" .. table.concat(self.base_directories, ':')
+    local cached = icon_map_cache[cache_key]
+    if cached and cached.generation == icon_index.get_generation() then
+        return cached.map
+    end
+
+    local ext_rank = {}
+    for rank, ext in ipairs(self.extensions) do
+        ext_rank[ext] = rank
+    end
+
+    local map = {}
     for _, subdir in ipairs(self.index_theme:get_subdirectories()) do
         for _, basedir in ipairs(self.base_directories) do
-            for _, ext in ipairs(self.extensions) do
-                if directory_matches_size(self, subdir, icon_size) then
-                    local filename = string.format("%s/%s/%s/%s.%s",
-                                                   basedir, self.icon_theme_name, subdir,
-                                                   icon_name, ext)
-                    if gfs.file_readable(filename) then
-                        return filename
-                    else
-                        checked_already[filename] = true
+            local dir = string.format("%s/%s/%s", basedir, self.icon_theme_name, subdir)
+            for file in pairs(icon_index.list(dir) or {}) do
+                local name, ext = file:match("^(.+)%.([^.]+)$")
+                local rank = ext and ext_rank[ext]
+                if rank then
+                    local candidates = map[name]
+                    if not candidates then
+                        candidates = {}
+                        map[name] = candidates
                     end
+                    local candidate = { subdir = subdir, dir = dir, rank = rank,
+                                        filename = dir .. "/" .. file }
+                    -- Keep the files of one directory in the order of the
+                    -- extensions.
+                    local pos = #candidates + 1
+                    while pos > 1 and candidates[pos - 1].dir == dir
+                            and candidates[pos - 1].rank > rank do
+                        pos = pos - 1
+                    end
+                    table.insert(candidates, pos, candidate)
                 end
             end
         end
     end
 
+    icon_map_cache[cache_key] = { generation = icon_index.get_generation(), map = map }
+    return map
+end
+
+local lookup_icon = function(self, icon_name, icon_size)
+    local candidates = get_icon_map(self)[icon_name]
+    if not candidates then
+        return nil
+    end
+
+    for _, candidate in ipairs(candidates) do
+        if directory_matches_size(self, candidate.subdir, icon_size) then
+            return candidate.filename
+        end
+    end
+
+    -- Among the subdirectories with the smallest size distance, the last
+    -- file wins.
     local minimal_size = 0xffffffff -- Any large number will do.
     local closest_filename = nil
-    for _, subdir in ipairs(self.index_theme:get_subdirectories()) do
-        local dist = directory_size_distance(self, subdir, icon_size)
-        if dist < minimal_size then
-            for _, basedir in ipairs(self.base_directories) do
-                for _, ext in ipairs(self.extensions) do
-                    local filename = string.format("%s/%s/%s/%s.%s",
-                                                   basedir, self.icon_theme_name, subdir,
-                                                   icon_name, ext)
-                    if not checked_already[filename] then
-                        if gfs.file_readable(filename) then
-                            closest_filename = filename
-                            minimal_size = dist
-                        end
-                    end
-                end
+    local subdir, accepted = nil, false
+    for _, candidate in ipairs(candidates) do
+        if candidate.subdir ~= subdir then
+            subdir = candidate.subdir
+            local dist = directory_size_distance(self, subdir, icon_size)
+            accepted = dist < minimal_size
+            if accepted then
+                minimal_size = dist
             end
         end
+        if accepted then
+            closest_filename = candidate.filename
+        end
     end
     return closest_filename
 end
@@ -206,11 +247,9 @@ end
 local lookup_fallback_icon = function(self, icon_name)
     for _, dir in ipairs(self.base_directories) do
         for _, ext in ipairs(self.extensions) do
-            local filename = string.format("%s/%s.%s",
-                                           dir,
-                                           icon_name, ext)
-            if gfs.file_readable(filename) then
-                return filename
+            local file = string.format("%s.%s", icon_name, ext)
+            if icon_index.file_exists(dir, file) then
+                return dir .. "/" .. file
             end
         end
     end
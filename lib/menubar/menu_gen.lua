@@ -11,6 +11,7 @@ local gtable = require("gears.table")
 local gfilesystem = require("gears.filesystem")
 local utils = require("menubar.utils")
 local icon_theme = require("menubar.icon_theme")
+local icon_index = require("menubar.icon_index")
 local pairs = pairs
 local ipairs = ipairs
 local string = string
@@ -90,6 +91,9 @@ end
 -- with the resulting list of menu entries as argument.
 -- @tparam table callback.entries All menu entries.
 function menu_gen.generate(callback)
+    -- Check the icon directories again, in case icons were installed
+    icon_index.clear()
+
     -- Update icons for category entries
     menu_gen.lookup_category_icons()
 
@@ -134,6 +138,7 @@ function menu_gen.generate(callback)
             end
             dirs_parsed = dirs_parsed + 1
             if dirs_parsed == #menu_gen.all_menu_dirs then
+                icon_index.save()
                 callback(result)
             end
         end)
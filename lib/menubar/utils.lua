@@ -10,6 +10,8 @@
 local io = io
 local table = table
 local ipairs = ipairs
+local pairs = pairs
+local tostring = tostring
 local string = string
 local screen = screen
 local gfs = require("gears.filesystem")
@@ -21,6 +23,7 @@ local wibox = require("wibox")
 local gdebug = require("gears.debug")
 local protected_call = require("gears.protected_call")
 local gstring = require("gears.string")
+local icon_index = require("menubar.icon_index")
 
 local utils = {}
 
@@ -119,6 +122,14 @@ local function get_icon_lookup_path()
     return icon_lookup_path
 end
 
+-- Check if a file exists in one of the icon lookup paths
+local function file_in_directory(directory, file)
+    if file:find("/", 1, true) then
+        return gfs.file_readable(directory .. "/" .. file)
+    end
+    return icon_index.file_exists(directory, file)
+end
+
 --- Lookup an icon in different folders of the filesystem.
 -- @tparam string icon_file Short or full name of the icon.
 -- @treturn string|boolean Full name of the icon, or false on failure.
@@ -134,16 +145,16 @@ function utils.lookup_icon_uncached(icon_file)
     else
         for _, directory in ipairs(get_icon_lookup_path()) do
             if is_format_supported(icon_file) and
-                    gfs.file_readable(directory .. "/" .. icon_file) then
+                    file_in_directory(directory, icon_file) then
                 return directory .. "/" .. icon_file
             else
                 -- Icon is probably specified without path and format,
                 -- like 'firefox'. Try to add supported extensions to
                 -- it and see if such file exists.
                 for _, format in ipairs(icon_formats) do
-                    local possible_file = directory .. "/" .. icon_file .. "." .. format
-                    if gfs.file_readable(possible_file) then
-                        return possible_file
+                    local possible_file = icon_file .. "." .. format
+                    if file_in_directory(directory, possible_file) then
+                        return directory .. "/" .. possible_file
                     end
                 end
             end
@@ -163,16 +174,14 @@ function utils.lookup_icon(icon)
     return lookup_icon_cache[icon] or default_icon
 end
 
---- Parse a .desktop file.
--- @param file The .desktop file.
--- @return A table with file entries.
-function utils.parse_desktop_file(file)
+-- Parse the lines of a .desktop file
+local function parse_desktop_lines(file, lines)
     local program = { show = true, file = file }
     local desktop_entry = false
 
     -- Parse the .desktop file.
     -- We are interested in [Desktop Entry] group only.
-    for line in io.lines(file) do
+    for line in lines do
         if line:find("^%s*#") then
             -- Skip comments.
             (function() end)() -- I haven't found a nice way to silence luacheck here
@@ -245,17 +254,57 @@ function utils.parse_desktop_file(file)
     return program
 end
 
+--- Parse a .desktop file.
+-- @param file The .desktop file.
+-- @return A table with file entries.
+function utils.parse_desktop_file(file)
+    return parse_desktop_lines(file, io.lines(file))
+end
+
+-- The parsed .desktop files, indexed by path. Each one remembers what it was
+-- parsed from, so that it is only parsed again when that changes.
+local desktop_file_cache = {}
+
+-- Get the parsed content of a .desktop file, reading it asynchronously if it
+-- is not in the cache. This must be called from a gio.Async coroutine.
+local function parse_desktop_file_cached(file_path, info)
+    local key = string.format("%d.%d:%d:%s:%s",
+        info:get_attribute_uint64("time::modified"),
+        info:get_attribute_uint32("time::modified-usec"),
+        info:get_size(), tostring(utils.terminal), tostring(utils.wm_name))
+    local cached = desktop_file_cache[file_path]
+    if cached and cached.key == key then
+        return cached.program
+    end
+
+    local ok, contents = gio.File.new_for_path(file_path):async_load_contents()
+    if not ok then
+        gdebug.print_error(contents)
+        return nil
+    end
+    local program = parse_desktop_lines(file_path,
+        (contents .. "\n"):gmatch("(.-)\n"))
+    desktop_file_cache[file_path] = { key = key, program = program or false }
+    return program
+end
+
 --- Parse a directory with .desktop files recursively.
+-- The files are read asynchronously. Files that did not change since the
+-- last call are not parsed again.
 -- @tparam string dir_path The directory path.
 -- @tparam function callback Will be fired when all the files were parsed
 -- with the resulting list of menu entries as argument.
 -- @tparam table callback.programs Paths of found .desktop files.
 function utils.parse_dir(dir_path, callback)
+    local seen = {}
 
     local function parser(dir, programs)
         local f = gio.File.new_for_path(dir)
         -- Except for "NONE" there is also NOFOLLOW_SYMLINKS
         local query = gio.FILE_ATTRIBUTE_STANDARD_NAME .. "," .. gio.FILE_ATTRIBUTE_STANDARD_TYPE
+            .. "," .. gio.FILE_ATTRIBUTE_STANDARD_SIZE
+            .. "," .. gio.FILE_ATTRIBUTE_TIME_MODIFIED
+            .. "," .. gio.FILE_ATTRIBUTE_TIME_MODIFIED_USEC
         local enum, err = f:async_enumerate_children(query, gio.FileQueryInfoFlags.NONE)
         if not enum then
             gdebug.print_error(err)
@@ -272,7 +321,8 @@ function utils.parse_dir(dir_path, callback)
                 local file_type = info:get_file_type()
                 local file_path = enum:get_child(info):get_path()
                 if file_type == 'REGULAR' then
-                    local program = utils.parse_desktop_file(file_path)
+                    seen[file_path] = true
+                    local program = parse_desktop_file_cached(file_path, info)
                     if program then
                         table.insert(programs, program)
                     end
@@ -290,6 +340,15 @@ function utils.parse_dir(dir_path, callback)
     gio.Async.start(function()
         local result = {}
         parser(dir_path, result)
+
+        -- Forget the files that were removed
+        local prefix = dir_path:match("^(.-)/*$") .. "/"
+        for file_path in pairs(desktop_file_cache) do
+            if not seen[file_path] and file_path:sub(1, #prefix) == prefix then
+                desktop_file_cache[file_path] = nil
+            end
+        end
+
         protected_call.call(callback, result)
     end)()
 end
@@ -306,7 +365,8 @@ end
 -- @tparam number|screen s Screen
 -- @treturn int Text width.
 function utils.compute_text_width(text, s)
-    return utils.compute_textbox_width(wibox.widget.textbox(gstring.xml_escape(text)), s)
+    s = screen[s or mouse.screen]
+    return wibox.widget.textbox.get_markup_geometry(gstring.xml_escape(text), s).width
 end
 
 return utils
@@ -77,6 +77,7 @@ local function do_redraw(self)
     -- Relayout
     if self._need_relayout or self._need_complete_repaint then
         self._need_relayout = false
+        self._widget_index = nil
         if self._widget_hierarchy and self.widget then
             local had_systray = systray_widget and self._widget_hierarchy:get_count(systray_widget) > 0
 
@@ -110,9 +111,11 @@ local function do_redraw(self)
     if self._dirty_area:is_empty() then
         return
     end
+    local dirty = {}
     for i = 0, self._dirty_area:num_rectangles() - 1 do
         local rect = self._dirty_area:get_rectangle(i)
         cr:rectangle(rect.x, rect.y, rect.width, rect.height)
+        dirty[i + 1] = { x = rect.x, y = rect.y, width = rect.width, height = rect.height }
     end
     self._dirty_area = cairo.Region.create()
     cr:clip()
@@ -160,42 +163,99 @@ local function do_redraw(self)
         self._widget_hierarchy:draw(context, cr)
     end
 
-    self.drawable:refresh()
+    -- Only the dirty area has to be copied to the screen
+    self.drawable:refresh(dirty)
 
     assert(cr.status == "SUCCESS", "Cairo context entered error state: " .. cr.status)
 end
 
-local function find_widgets(_drawable, result, _hierarchy, x, y)
-    local m = _hierarchy:get_matrix_from_device()
+-- Size of the cells of the grid that find_widgets uses to look up widgets
+local index_cell_size = 64
 
-    -- Is (x,y) inside of this hierarchy or any child (aka the draw extents)
-    local x1, y1 = m:transform_point(x, y)
-    local x2, y2, w2, h2 = _hierarchy:get_draw_extents()
-    if x1 < x2 or x1 >= x2 + w2 then
-        return
-    end
-    if y1 < y2 or y1 >= y2 + h2 then
-        return
-    end
+local function index_cell_key(cx, cy)
+    return cy * 1048576 + cx
+end
 
-    -- Is (x,y) inside of this widget?
-    local width, height = _hierarchy:get_size()
-    if x1 >= 0 and y1 >= 0 and x1 <= width and y1 <= height then
-        -- Get the extents of this widget in the device space
-        local x3, y3, w3, h3 = matrix.transform_rectangle(_hierarchy:get_matrix_to_device(),
+-- Build a spatial index over the widget hierarchy of a drawable. The index is a
+-- uniform grid in device space. Each cell lists the hierarchies whose extents
+-- touch it, in the order of a depth-first walk through the hierarchy.
+local function build_widget_index(self)
+    local cells = {}
+    local geom = self.drawable:geometry()
+    local max_cx = math.floor(geom.width / index_cell_size)
+    local max_cy = math.floor(geom.height / index_cell_size)
+
+    local function add(_hierarchy, parent)
+        local width, height = _hierarchy:get_size()
+        local x, y, w, h = matrix.transform_rectangle(_hierarchy:get_matrix_to_device(),
             0, 0, width, height)
-        table.insert(result, {
-            x = x3, y = y3, width = w3, height = h3,
+        local entry = {
+            hierarchy = _hierarchy,
+            parent = parent,
+            x = x, y = y, width = w, height = h,
             widget_width = width,
             widget_height = height,
-            drawable = _drawable,
-            widget = _hierarchy:get_widget(),
-            hierarchy = _hierarchy
-        })
+            -- The inverse of the matrix to the device, computed when needed
+            from_device = nil
+        }
+
+        -- Points on the right and bottom edge are part of the widget
+        for cy = math.max(0, math.floor(y / index_cell_size)),
+                math.min(max_cy, math.floor((y + h) / index_cell_size)) do
+            for cx = math.max(0, math.floor(x / index_cell_size)),
+                    math.min(max_cx, math.floor((x + w) / index_cell_size)) do
+                local key = index_cell_key(cx, cy)
+                local cell = cells[key]
+                if not cell then
+                    cell = {}
+                    cells[key] = cell
+                end
+                cell[#cell + 1] = entry
+            end
+        end
+
+        for _, child in ipairs(_hierarchy:get_children()) do
+            add(child, entry)
+        end
     end
-    for _, child in ipairs(_hierarchy:get_children()) do
-        find_widgets(_drawable, result, child, x, y)
+
+    add(self._widget_hierarchy, nil)
+    return cells
+end
+
+-- Transform a point into the coordinate system of an index entry
+local function index_entry_point(entry, x, y)
+    local m = entry.from_device
+    if not m then
+        m = entry.hierarchy:get_matrix_from_device()
+        entry.from_device = m
     end
+    return m:transform_point(x, y)
+end
+
+-- Is (x,y) inside of this hierarchy or any child (aka the draw extents)
+local function index_entry_in_extents(entry, x, y)
+    local x1, y1 = index_entry_point(entry, x, y)
+    local x2, y2, w2, h2 = entry.hierarchy:get_draw_extents()
+    return x1 >= x2 and x1 < x2 + w2 and y1 >= y2 and y1 < y2 + h2, x1, y1
+end
+
+local function index_entry_contains(entry, x, y)
+    -- Is (x,y) inside of this widget?
+    local inside, x1, y1 = index_entry_in_extents(entry, x, y)
+    if not inside or x1 < 0 or y1 < 0 or x1 > entry.widget_width or y1 > entry.widget_height then
+        return false
+    end
+
+    -- Widgets outside of the draw extents of their parents are not found
+    local parent = entry.parent
+    while parent do
+        if not index_entry_in_extents(parent, x, y) then
+            return false
+        end
+        parent = parent.parent
+    end
+    return true
 end
 
 --- Find a widget by a point.
@@ -212,8 +272,28 @@ end
 -- coordinate system (which may e.g. be rotated and scaled).
 function drawable:find_widgets(x, y)
     local result = {}
-    if self._widget_hierarchy then
-        find_widgets(self, result, self._widget_hierarchy, x, y)
+    if not self._widget_hierarchy then
+        return result
+    end
+
+    -- The index is rebuilt lazily after the hierarchy changed
+    if not self._widget_index then
+        self._widget_index = build_widget_index(self)
+    end
+
+    local cell = self._widget_index[index_cell_key(math.floor(x / index_cell_size),
+        math.floor(y / index_cell_size))]
+    for _, entry in ipairs(cell or {}) do
+        if index_entry_contains(entry, x, y) then
+            table.insert(result, {
+                x = entry.x, y = entry.y, width = entry.width, height = entry.height,
+                widget_width = entry.widget_width,
+                widget_height = entry.widget_height,
+                drawable = self,
+                widget = entry.hierarchy:get_widget(),
+                hierarchy = entry.hierarchy
+            })
+        end
     end
     return result
 end
@@ -18,6 +18,9 @@ local hierarchy = {}
 
 local widgets_to_count = setmetatable({}, { __mode = "k" })
 
+-- Layout result of widgets without children
+local no_children = {}
+
 --- Add a widget to the list of widgets for which hierarchies should count their
 -- occurrences. Note that for correct operations, the widget must not yet be
 -- visible in any hierarchy.
@@ -26,6 +29,15 @@ function hierarchy.count_widget(widget)
     widgets_to_count[widget] = true
 end
 
+-- Scratch rectangle for adding areas to regions without allocating
+local scratch_rect = cairo.RectangleInt()
+
+local function union_rectangle(region, x, y, width, height)
+    scratch_rect.x, scratch_rect.y = x, y
+    scratch_rect.width, scratch_rect.height = width, height
+    region:union_rectangle(scratch_rect)
+end
+
 local function hierarchy_new(redraw_callback, layout_callback, callback_arg)
     local result = {
         _matrix = matrix.identity,
@@ -48,7 +60,11 @@ local function hierarchy_new(redraw_callback, layout_callback, callback_arg)
         },
         _parent = nil,
         _children = {},
+        -- Former children, kept for reuse when the number of children grows
+        _spare_children = {},
         _widget_counts = {},
+        -- The widget that this hierarchy counts for itself, if any
+        _counted = nil,
     }
 
     function result._redraw()
@@ -81,6 +97,45 @@ local function hierarchy_new(redraw_callback, layout_callback, callback_arg)
     return result
 end
 
+-- Add to the count of a widget in a hierarchy and all of its parents.
+local function add_count(self, widget, delta)
+    while self do
+        local count = (self._widget_counts[widget] or 0) + delta
+        self._widget_counts[widget] = count ~= 0 and count or nil
+        self = self._parent
+    end
+end
+
+local function disconnect_signals(self)
+    self._widget:disconnect_signal("widget::redraw_needed", self._redraw)
+    self._widget:disconnect_signal("widget::layout_changed", self._layout)
+    self._widget:disconnect_signal("widget::emit_recursive", self._emit_recursive)
+end
+
+-- Reset a hierarchy that is no longer part of its parent, so that it can later
+-- be reused for any other widget. Its children become spares.
+local hierarchy_release
+function hierarchy_release(self)
+    if self._widget then
+        disconnect_signals(self)
+    end
+    self._widget = nil
+    self._context = nil
+    self._counted = nil
+    self._need_update = true
+    self._size.width, self._size.height = nil, nil
+    for w in pairs(self._widget_counts) do
+        self._widget_counts[w] = nil
+    end
+
+    local children, spare = self._children, self._spare_children
+    for i = #children, 1, -1 do
+        hierarchy_release(children[i])
+        spare[#spare + 1] = children[i]
+        children[i] = nil
+    end
+end
+
 local hierarchy_update
 function hierarchy_update(self, context, widget, width, height, region, matrix_to_parent, matrix_to_device)
     if (not self._need_update) and self._widget == widget and
@@ -103,12 +158,11 @@ function hierarchy_update(self, context, widget, width, height, region, matrix_t
     else
         old_x, old_y, old_width, old_height = 0, 0, 0, 0
     end
+    local device_changed = not matrix.equals(self._matrix_to_device, matrix_to_device)
 
     -- Disconnect old signals
     if old_widget and old_widget ~= widget then
-        self._widget:disconnect_signal("widget::redraw_needed", self._redraw)
-        self._widget:disconnect_signal("widget::layout_changed", self._layout)
-        self._widget:disconnect_signal("widget::emit_recursive", self._emit_recursive)
+        disconnect_signals(self)
     end
 
     -- Save the arguments we need to save
@@ -126,69 +180,82 @@ function hierarchy_update(self, context, widget, width, height, region, matrix_t
         widget:weak_connect_signal("widget::emit_recursive", self._emit_recursive)
     end
 
-    -- Update children
-    local old_children = self._children
-    local layout_result = base.layout_widget(no_parent, context, widget, width, height)
-    self._children = {}
-    for _, w in ipairs(layout_result or {}) do
-        local r = table.remove(old_children, 1)
+    -- Update the widget counts for this hierarchy itself. Changes in the
+    -- children are added to the counts of all parents when they happen.
+    local counted = widgets_to_count[widget] and width > 0 and height > 0 and widget or nil
+    if counted ~= self._counted then
+        if self._counted then
+            add_count(self, self._counted, -1)
+        end
+        if counted then
+            add_count(self, counted, 1)
+        end
+        self._counted = counted
+    end
+
+    -- Update children, reusing the existing hierarchies by index
+    local children = self._children
+    local layout_result = base.layout_widget(no_parent, context, widget, width, height) or no_children
+    local num_children = #layout_result
+    for i = 1, num_children do
+        local w = layout_result[i]
+        local r = children[i]
+        local child_to_device
+        if r and not device_changed and matrix.equals(r._matrix, w._matrix) then
+            child_to_device = r._matrix_to_device
+        else
+            child_to_device = w._matrix * matrix_to_device
+        end
         if not r then
-            r = hierarchy_new(self._redraw_callback, self._layout_callback, self._callback_arg)
+            r = table.remove(self._spare_children) or
+                hierarchy_new(self._redraw_callback, self._layout_callback, self._callback_arg)
             r._parent = self
+            children[i] = r
         end
-        hierarchy_update(r, context, w._widget, w._width, w._height, region, w._matrix, w._matrix * matrix_to_device)
-        table.insert(self._children, r)
+        hierarchy_update(r, context, w._widget, w._width, w._height, region, w._matrix, child_to_device)
+    end
+
+    -- Are there any children which were removed? Their area needs a redraw.
+    local spare = self._spare_children
+    for i = #children, num_children + 1, -1 do
+        local child = children[i]
+        children[i] = nil
+
+        local x, y, w, h = matrix.transform_rectangle(child._matrix_to_device, child:get_draw_extents())
+        union_rectangle(region, x, y, w, h)
+
+        for counted_widget, count in pairs(child._widget_counts) do
+            add_count(self, counted_widget, -count)
+        end
+        child._parent = nil
+        hierarchy_release(child)
+        spare[#spare + 1] = child
     end
 
     -- Calculate the draw extents
     local x1, y1, x2, y2 = 0, 0, width, height
-    for _, h in ipairs(self._children) do
-        local px, py, pwidth, pheight = matrix.transform_rectangle(h._matrix, h:get_draw_extents())
+    for i = 1, num_children do
+        local px, py, pwidth, pheight = matrix.transform_rectangle(children[i]._matrix,
+            children[i]:get_draw_extents())
         x1 = math.min(x1, px)
         y1 = math.min(y1, py)
         x2 = math.max(x2, px + pwidth)
         y2 = math.max(y2, py + pheight)
     end
-    self._draw_extents = {
-        x = x1, y = y1,
-        width = x2 - x1,
-        height = y2 - y1
-    }
-
-    -- Update widget counts
-    self._widget_counts = {}
-    if widgets_to_count[widget] and width > 0 and height > 0 then
-        self._widget_counts[widget] = 1
-    end
-    for _, h in ipairs(self._children) do
-        for w, count in pairs(h._widget_counts) do
-            self._widget_counts[w] = (self._widget_counts[w] or 0) + count
-        end
-    end
+    local ext = self._draw_extents
+    ext.x, ext.y = x1, y1
+    ext.width, ext.height = x2 - x1, y2 - y1
 
     -- Check which part needs to be redrawn
 
-    -- Are there any children which were removed? Their area needs a redraw.
-    for _, child in ipairs(old_children) do
-        local x, y, w, h = matrix.transform_rectangle(child._matrix_to_device, child:get_draw_extents())
-        region:union_rectangle(cairo.RectangleInt{
-            x = x, y = y, width = w, height = h
-        })
-        child._parent = nil
-    end
-
     -- Did we change and need to be redrawn?
     local x, y, w, h = matrix.transform_rectangle(self._matrix_to_device, 0, 0, self._size.width, self._size.height)
     local new_x, new_y = math.floor(x), math.floor(y)
     local new_width, new_height = math.ceil(x + w) - new_x, math.ceil(y + h) - new_y
     if new_x ~= old_x or new_y ~= old_y or new_width ~= old_width or new_height ~= old_height or
             widget ~= old_widget then
-        region:union_rectangle(cairo.RectangleInt{
-            x = old_x, y = old_y, width = old_width, height = old_height
-        })
-        region:union_rectangle(cairo.RectangleInt{
-            x = new_x, y = new_y, width = new_width, height = new_height
-        })
+        union_rectangle(region, old_x, old_y, old_width, old_height)
+        union_rectangle(region, new_x, new_y, new_width, new_height)
     end
 end
 
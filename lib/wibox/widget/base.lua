@@ -210,15 +210,35 @@ end
 -- Indexes are widgets, allow them to be garbage-collected.
 local widget_dependencies = setmetatable({}, { __mode = "kv" })
 
--- Get the cache of the given kind for this widget. This returns a gears.cache
--- that calls the callback of kind `kind` on the widget.
-local function get_cache(widget, kind)
-    if not widget._private.widget_caches[kind] then
-        widget._private.widget_caches[kind] = cache.new(function(...)
-            return protected_call(widget[kind], widget, ...)
-        end)
-    end
-    return widget._private.widget_caches[kind]
+-- The caches are dropped when the layout changes, so they only have to hold
+-- the few sizes a widget is asked for in between. Keeping them out of reach of
+-- the garbage collector avoids fitting and laying out everything again after
+-- each collection.
+local widget_cache_args = { max_size = 16 }
+
+-- The context of the call that is about to ask a cache. The caches do not keep
+-- it, so that they do not keep the context and its drawable alive.
+local current_context
+
+-- Get the cache of the given kind for this widget in a context. This returns a
+-- gears.cache that calls the callback of kind `kind` on the widget. The caches
+-- are indexed weakly by context, so that widgets do not keep the drawables they
+-- were shown in alive. Only the sizes in one context are bounded.
+local function get_cache(widget, kind, context)
+    local caches = widget._private.widget_caches[kind]
+    if not caches then
+        caches = setmetatable({}, { __mode = "k" })
+        widget._private.widget_caches[kind] = caches
+    end
+    local result = caches[context]
+    if not result then
+        result = cache.new(function(...)
+            return protected_call(widget[kind], widget, current_context, ...)
+        end, widget_cache_args)
+        caches[context] = result
+    end
+    current_context = context
+    return result
 end
 
 -- Special value to skip the dependency recording that is normally done by
@@ -290,7 +310,7 @@ function base.fit_widget(parent, context, widget, width, height)
 
     local w, h = 0, 0
     if widget.fit then
-        w, h = get_cache(widget, "fit"):get(context, width, height)
+        w, h = get_cache(widget, "fit", context):get(width, height)
     else
         -- If it has no fit method, calculate based on the size of children
         local children = base.layout_widget(parent, context, widget, width, height)
@@ -337,7 +357,7 @@ function base.layout_widget(parent, context, widget, width, height)
     height = math.max(0, height)
 
     if widget.layout then
-        return get_cache(widget, "layout"):get(context, width, height)
+        return get_cache(widget, "layout", context):get(width, height)
     end
 end
 
@@ -19,8 +19,8 @@
 local setmetatable = setmetatable
 local ipairs = ipairs
 local math = math
-local table = table
-local type = type
+local pairs = pairs
+local cairo = require("lgi").cairo
 local color = require("gears.color")
 local base = require("wibox.widget.base")
 local beautiful = require("beautiful")
@@ -109,15 +109,303 @@ local properties = { "width", "height", "border_color", "stack",
                      "max_value", "scale", "min_value", "step_shape",
                      "step_spacing", "step_width" }
 
+-- {{{ Sample storage
+
+-- The samples live in a ring buffer sized to the number of columns that can be
+-- shown. Next to it, two monotonic queues hold the candidates for the running
+-- maximum and minimum, so neither adding a sample nor scaling the graph has to
+-- walk the whole history.
+
+local function queue_new()
+    return { first = 1, last = 0, serials = {}, values = {} }
+end
+
+-- Queue a new sample, dropping the older ones it makes irrelevant: they are
+-- evicted before it and can thus never be the extremum again.
+local function queue_push(queue, serial, value, dominates)
+    local last = queue.last
+    while last >= queue.first and not dominates(queue.values[last], value) do
+        queue.serials[last], queue.values[last] = nil, nil
+        last = last - 1
+    end
+    last = last + 1
+    queue.serials[last], queue.values[last] = serial, value
+    queue.last = last
+end
+
+-- Forget the sample with the given serial if it is still queued
+local function queue_evict(queue, serial)
+    local first = queue.first
+    if first <= queue.last and queue.serials[first] == serial then
+        queue.serials[first], queue.values[first] = nil, nil
+        queue.first = first + 1
+    end
+end
+
+local function greater(a, b) return a > b end
+local function less(a, b) return a < b end
+
+local function ring_new(capacity, total)
+    return {
+        data     = {},
+        capacity = capacity,
+        count    = 0,
+        -- The serial of the newest sample, it keeps growing when old
+        -- samples are dropped
+        total    = total or 0,
+        max      = queue_new(),
+        min      = queue_new(),
+    }
+end
+
+local function ring_push(ring, value)
+    local serial = ring.total + 1
+    if ring.count == ring.capacity then
+        local oldest = serial - ring.capacity
+        queue_evict(ring.max, oldest)
+        queue_evict(ring.min, oldest)
+    else
+        ring.count = ring.count + 1
+    end
+    ring.data[(serial - 1) % ring.capacity + 1] = value
+    ring.total = serial
+    queue_push(ring.max, serial, value, greater)
+    queue_push(ring.min, serial, value, less)
+end
+
+-- Get a sample by its age, the newest one has age 0
+local function ring_get(ring, age)
+    return ring.data[(ring.total - age - 1) % ring.capacity + 1]
+end
+
+-- Copy the newest samples into a ring of another capacity
+local function ring_resize(ring, capacity)
+    local kept = math.min(ring.count, capacity)
+    local resized = ring_new(capacity, ring.total - kept)
+    for age = kept - 1, 0, -1 do
+        ring_push(resized, ring_get(ring, age))
+    end
+    return resized
+end
+
+local function ring_max(ring)
+    return ring.max.values[ring.max.first]
+end
+
+local function ring_min(ring)
+    return ring.min.values[ring.min.first]
+end
+
+-- }}}
+
+-- Get the number of samples that fit in the graph
+local function get_capacity(self)
+    return self._private.width - (self._private.border_color and 2 or 0)
+end
+
+-- Add the columns of the samples aged `first` to `last` to the path and paint
+-- them, the newest sample being on the left.
+local function draw_columns(self, cr, width, height, max_value, min_value, first, last)
+    local priv = self._private
+
+    -- Draw a stacked graph
+    if priv.stack then
+        if not priv.stack_colors then return end
+
+        last = math.min(last, width)
+
+        -- The columns of a group never overlap, so each group is painted at
+        -- once, on top of the groups below it.
+        local bases = {}
+        for idx, col in ipairs(priv.stack_colors) do
+            local ring = priv.stack_values[idx]
+            if ring and ring.count > first then
+                for i = first, math.min(last, ring.count - 1) do
+                    local rel_i = bases[i] or 0
+                    local value = ring_get(ring, i) + rel_i
+                    local rel_x = i + 0.5
+                    cr:move_to(rel_x, height * (1 - (rel_i / max_value)))
+                    cr:line_to(rel_x, height * (1 - (value / max_value)))
+                    bases[i] = value
+                end
+                cr:set_source(color(col or beautiful.graph_fg or "#ff0000"))
+                cr:stroke()
+            end
+        end
+
+        return
+    end
+
+    local ring = priv.values
+    local step_shape = priv.step_shape
+    local step_spacing = priv.step_spacing or 0
+    local step_width = priv.step_width or 1
+
+    last = math.min(last, ring.count - 1)
+
+    -- Draw the background on no value
+    if first > last then return end
+
+    -- Draw reverse
+    for i = first, last do
+        local value = ring_get(ring, i)
+        if value >= 0 then
+            local x = i*step_width + ((i-1)*step_spacing) + 0.5
+            value = (value - min_value) / max_value
+            cr:move_to(x, height * (1 - value))
+
+            if step_shape then
+                cr:translate(step_width + (i>1 and step_spacing or 0), height * (1 - value))
+                step_shape(cr, step_width, height)
+                cr:translate(0, -(height * (1 - value)))
+            elseif step_width > 1 then
+                cr:rectangle(x, height * (1 - value), step_width, height)
+            else
+                cr:line_to(x, height)
+            end
+        end
+    end
+    cr:set_source(color(priv.color or beautiful.graph_fg or "#ff0000"))
+
+    if step_shape or step_width > 1 then
+        cr:fill()
+    else
+        cr:stroke()
+    end
+end
+
+-- Get by how many pixels the columns move for each new sample, or nil if the
+-- previous rendering cannot simply be shifted.
+local function get_shift_step(self)
+    local priv = self._private
+    if priv.stack then
+        return 1
+    end
+    if priv.step_shape then
+        return nil
+    end
+    local step = (priv.step_width or 1) + (priv.step_spacing or 0)
+    if step < 1 or step ~= math.floor(step) then
+        return nil
+    end
+    return step
+end
+
+-- Check if a rendering can be copied as-is to the target of the context
+local function is_pixel_aligned(cr)
+    local kind = cr:get_target():get_type()
+    if kind ~= "IMAGE" and kind ~= "XCB" and kind ~= "XLIB" then
+        return false
+    end
+    local m = cr:get_matrix()
+    return m.xx == 1 and m.yx == 0 and m.xy == 0 and m.yy == 1
+        and m.x0 == math.floor(m.x0) and m.y0 == math.floor(m.y0)
+end
+
+-- Get the serial of the newest sample of each drawn series
+local function get_totals(self, totals)
+    local priv = self._private
+    if not priv.stack then
+        totals[1] = priv.values.total
+        return totals
+    end
+    for idx in ipairs(priv.stack_colors or {}) do
+        local ring = priv.stack_values[idx]
+        totals[idx] = ring and ring.total or 0
+    end
+    return totals
+end
+
+-- Get how many samples were added to every series since the rendering was
+-- cached, or nil if the series did not all grow by the same amount.
+local function get_new_samples(self, cache)
+    local totals = get_totals(self, {})
+    local new
+    for idx, total in ipairs(totals) do
+        local added = total - (cache.totals[idx] or 0)
+        if added < 0 or (new and new ~= added) then
+            return nil
+        end
+        new = added
+    end
+    if #totals ~= #cache.totals then
+        return nil
+    end
+    return new or 0
+end
+
+-- Bring the cached rendering of the plot up to date. When the scale did not
+-- change, the previous rendering is shifted and only the new columns are
+-- drawn.
+local function update_cache(self, cr, width, height, max_value, min_value, step)
+    local priv = self._private
+    local cache = priv.plot_cache
+
+    if not cache or cache.width ~= width or cache.height ~= height then
+        local target = cr:get_target()
+        cache = {
+            width   = width,
+            height  = height,
+            surface = target:create_similar(cairo.Content.COLOR_ALPHA, width, height),
+            spare   = target:create_similar(cairo.Content.COLOR_ALPHA, width, height),
+            totals  = {},
+        }
+        priv.plot_cache = cache
+    end
+
+    local new = cache.valid and cache.max_value == max_value
+        and cache.min_value == min_value and get_new_samples(self, cache)
+
+    if new == 0 then
+        return cache.surface
+    end
+
+    local surface = cache.surface
+    local pcr
+    if new and new * step < width then
+        surface = cache.spare
+        pcr = cairo.Context(surface)
+        pcr:set_operator(cairo.Operator.SOURCE)
+        pcr:set_source_surface(cache.surface, new * step, 0)
+        pcr:paint()
+
+        -- Also redraw the newest of the old columns, since it may share
+        -- a pixel with the new ones.
+        local clear_x = new + 1
+        if not priv.stack then
+            clear_x = (new + 1) * (priv.step_width or 1) + new * (priv.step_spacing or 0)
+        end
+        pcr:rectangle(0, 0, clear_x, height)
+        pcr:clip()
+        pcr:set_operator(cairo.Operator.CLEAR)
+        pcr:paint()
+        pcr:set_operator(cairo.Operator.OVER)
+        pcr:set_line_width(1)
+        draw_columns(self, pcr, width, height, max_value, min_value, 0, new)
+
+        cache.spare = cache.surface
+        cache.surface = surface
+    else
+        pcr = cairo.Context(surface)
+        pcr:set_operator(cairo.Operator.CLEAR)
+        pcr:paint()
+        pcr:set_operator(cairo.Operator.OVER)
+        pcr:set_line_width(1)
+        draw_columns(self, pcr, width, height, max_value, min_value, 0, math.huge)
+    end
+    surface:flush()
+
+    cache.valid = true
+    cache.max_value, cache.min_value = max_value, min_value
+    get_totals(self, cache.totals)
+
+    return surface
+end
+
 function graph.draw(_graph, _, cr, width, height)
     local max_value = _graph._private.max_value
     local min_value = _graph._private.min_value or (
         _graph._private.scale and math.huge or 0)
-    local values = _graph._private.values
-
-    local step_shape = _graph._private.step_shape
-    local step_spacing = _graph._private.step_spacing or 0
-    local step_width = _graph._private.step_width or 1
 
     cr:set_line_width(1)
 
@@ -132,82 +420,26 @@ function graph.draw(_graph, _, cr, width, height)
         width, height = width - 2, height - 2
     end
 
-    -- Draw a stacked graph
-    if _graph._private.stack then
-
-        if _graph._private.scale then
-            for _, v in ipairs(values) do
-                for _, sv in ipairs(v) do
-                    if sv > max_value then
-                        max_value = sv
-                    end
-                    if min_value > sv then
-                        min_value = sv
-                    end
-                end
+    if _graph._private.scale then
+        if _graph._private.stack then
+            for _, ring in pairs(_graph._private.stack_values) do
+                max_value = math.max(max_value, ring_max(ring) or max_value)
+                min_value = math.min(min_value, ring_min(ring) or min_value)
             end
+        else
+            local ring = _graph._private.values
+            max_value = math.max(max_value, ring_max(ring) or max_value)
+            min_value = math.min(min_value, ring_min(ring) or min_value)
         end
+    end
 
-        for i = 0, width do
-            local rel_i = 0
-            local rel_x = i + 0.5
-
-            if _graph._private.stack_colors then
-                for idx, col in ipairs(_graph._private.stack_colors) do
-                    local stack_values = values[idx]
-                    if stack_values and i < #stack_values then
-                        local value = stack_values[#stack_values - i] + rel_i
-                        cr:move_to(rel_x, height * (1 - (rel_i / max_value)))
-                        cr:line_to(rel_x, height * (1 - (value / max_value)))
-                        cr:set_source(color(col or beautiful.graph_fg or "#ff0000"))
-                        cr:stroke()
-                        rel_i = value
-                    end
-                end
-            end
-        end
+    local step = get_shift_step(_graph)
+    if step and width > 0 and height > 0 and is_pixel_aligned(cr) then
+        cr:set_source_surface(update_cache(_graph, cr, width, height,
+            max_value, min_value, step), 0, 0)
+        cr:paint()
     else
-        if _graph._private.scale then
-            for _, v in ipairs(values) do
-                if v > max_value then
-                    max_value = v
-                end
-                if min_value > v then
-                    min_value = v
-                end
-            end
-        end
-
-        -- Draw the background on no value
-        if #values ~= 0 then
-            -- Draw reverse
-            for i = 0, #values - 1 do
-                local value = values[#values - i]
-                if value >= 0 then
-                    local x = i*step_width + ((i-1)*step_spacing) + 0.5
-                    value = (value - min_value) / max_value
-                    cr:move_to(x, height * (1 - value))
-
-                    if step_shape then
-                        cr:translate(step_width + (i>1 and step_spacing or 0), height * (1 - value))
-                        step_shape(cr, step_width, height)
-                        cr:translate(0, -(height * (1 - value)))
-                    elseif step_width > 1 then
-                        cr:rectangle(x, height * (1 - value), step_width, height)
-                    else
-                        cr:line_to(x, height)
-                    end
-                end
-            end
-            cr:set_source(color(_graph._private.color or beautiful.graph_fg or "#ff0000"))
-
-            if step_shape or step_width > 1 then
-                cr:fill()
-            else
-                cr:stroke()
-            end
-        end
-
+        draw_columns(_graph, cr, width, height, max_value, min_value, 0, math.huge)
     end
 
     -- Undo the cr:translate() for the border and step shapes
@@ -235,38 +467,39 @@ end
 -- @param group The stack color group index.
 function graph:add_value(value, group)
     value = value or 0
-    local values = self._private.values
     local max_value = self._private.max_value
     value = math.max(0, value)
     if not self._private.scale then
         value = math.min(max_value, value)
     end
 
+    local rings, key = self._private, "values"
     if self._private.stack and group then
-        if not  self._private.values[group]
-        or type(self._private.values[group]) ~= "table"
-        then
-            self._private.values[group] = {}
-        end
-        values = self._private.values[group]
+        rings, key = self._private.stack_values, group
     end
-    table.insert(values, value)
-
-    local border_width = 0
-    if self._private.border_color then border_width = 2 end
 
     -- Ensure we never have more data than we can draw
-    while #values > self._private.width - border_width do
-        table.remove(values, 1)
+    local capacity = get_capacity(self)
+    local ring = rings[key]
+    if not ring then
+        ring = ring_new(capacity)
+        rings[key] = ring
+    elseif ring.capacity ~= capacity then
+        ring = ring_resize(ring, capacity)
+        rings[key] = ring
     end
 
+    ring_push(ring, value)
+
     self:emit_signal("widget::redraw_needed")
     return self
 end
 
 --- Clear the graph.
 function graph:clear()
-    self._private.values = {}
+    self._private.values = ring_new(get_capacity(self))
+    self._private.stack_values = {}
+    self._private.plot_cache = nil
     self:emit_signal("widget::redraw_needed")
     return self
 end
@@ -297,6 +530,7 @@ for _, prop in ipairs(properties) do
         graph["set_" .. prop] = function(_graph, value)
             if _graph._private[prop] ~= value then
                 _graph._private[prop] = value
+                _graph._private.plot_cache = nil
                 _graph:emit_signal("widget::redraw_needed")
             end
             return _graph
@@ -326,8 +560,9 @@ function graph.new(args)
 
     _graph._private.width     = width
     _graph._private.height    = height
-    _graph._private.values    = {}
     _graph._private.max_value = 1
+    _graph._private.values    = ring_new(width)
+    _graph._private.stack_values = {}
 
     -- Set methods
     _graph.add_value = graph["add_value"]
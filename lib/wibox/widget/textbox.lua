@@ -21,49 +21,148 @@ local textbox = { mt = {} }
 --- The textbox font.
 -- @beautiful beautiful.font
 
---- Set the DPI of a Pango layout
-local function setup_dpi(box, dpi)
-    if box._private.dpi ~= dpi then
-        box._private.dpi = dpi
-        box._private.ctx:set_resolution(dpi)
-        box._private.layout:context_changed()
+-- Process-wide cache of prepared Pango layouts. Many textboxes show the same
+-- text in the same font, e.g. in tasklists, taglists and menus. The cache has
+-- two generations: when the current one is full, it replaces the old one, so
+-- that entries which are still in use are moved back into the current one.
+local layout_cache = {
+    current = {},
+    old = {},
+    size = 0,
+    max_size = 500,
+    hits = 0,
+    misses = 0,
+}
+
+-- Pango contexts for each DPI value, shared by the cached layouts
+local contexts = {}
+
+-- The context of the layouts that only hold the content of the textboxes
+local content_context = PangoCairo.font_map_get_default():create_context()
+
+local max_lines = 2^20
+
+-- Measure the logical size of a cached layout. Drawing applies the font
+-- options of the target to the shared context, so the size is measured again
+-- when the context changed since the last time.
+local function measure_entry(entry)
+    local serial = entry.layout:get_context():get_serial()
+    if entry.serial ~= serial then
+        local _, logical = entry.layout:get_pixel_extents()
+        entry.width, entry.height = logical.width, logical.height
+        entry.serial = serial
     end
+    return entry
 end
 
---- Setup a pango layout for the given textbox and dpi
-local function setup_layout(box, width, height, dpi)
-    box._private.layout.width = Pango.units_from_double(width)
-    box._private.layout.height = Pango.units_from_double(height)
-    setup_dpi(box, dpi)
+--- Get a prepared layout and its logical size from the cache.
+-- @tparam string content_key Describes everything that the `fill` function
+--   sets on the layout.
+-- @tparam number width The width of the layout in Pango units.
+-- @tparam number height The height of the layout in Pango units.
+-- @tparam number dpi The DPI value to render at.
+-- @tparam function fill Function that is called with a new layout and `arg`
+--   to set up the layout on a cache miss.
+-- @param arg The argument for `fill`.
+-- @treturn table A table with the `layout` and its logical `width` and
+--   `height` in pixels.
+local function get_cached_layout(content_key, width, height, dpi, fill, arg)
+    local key = content_key .. "\0" .. width .. "\0" .. height .. "\0" .. dpi
+    local entry = layout_cache.current[key]
+    if entry then
+        layout_cache.hits = layout_cache.hits + 1
+        return measure_entry(entry)
+    end
+
+    entry = layout_cache.old[key]
+    if entry then
+        layout_cache.hits = layout_cache.hits + 1
+        layout_cache.old[key] = nil
+    else
+        layout_cache.misses = layout_cache.misses + 1
+
+        local ctx = contexts[dpi]
+        if not ctx then
+            ctx = PangoCairo.font_map_get_default():create_context()
+            ctx:set_resolution(dpi)
+            contexts[dpi] = ctx
+        end
+
+        local layout = Pango.Layout.new(ctx)
+        fill(layout, arg)
+        layout.width = width
+        layout.height = height
+        entry = { layout = layout }
+    end
+    measure_entry(entry)
+
+    if layout_cache.size >= layout_cache.max_size then
+        layout_cache.old = layout_cache.current
+        layout_cache.current = {}
+        layout_cache.size = 0
+    end
+    layout_cache.current[key] = entry
+    layout_cache.size = layout_cache.size + 1
+    return entry
+end
+
+-- Copy the content of a textbox to a new layout
+local function fill_from_textbox(layout, box)
+    local template = box._private.layout
+    layout:set_font_description(template:get_font_description())
+    layout:set_ellipsize(template:get_ellipsize())
+    layout:set_wrap(template:get_wrap())
+    layout:set_alignment(template:get_alignment())
+    layout.text = template.text
+    layout.attributes = template.attributes
+end
+
+-- Update the key that describes the content of a textbox in the layout cache
+local function update_content_key(box)
+    local template = box._private.layout
+    box._private.content_key = table.concat({
+        box._private.markup and "m" or "t",
+        box._private.markup or template.text or "",
+        box._private.font_name or "",
+        template:get_ellipsize(),
+        template:get_wrap(),
+        template:get_alignment(),
+    }, "\0")
+end
+
+--- Get the cached layout for the given textbox, size and dpi
+local function get_layout(box, width, height, dpi)
+    return get_cached_layout(box._private.content_key, width, height, dpi,
+        fill_from_textbox, box)
 end
 
 -- Draw the given textbox on the given cairo context in the given geometry
 function textbox:draw(context, cr, width, height)
-    setup_layout(self, width, height, context.dpi)
-    cr:update_layout(self._private.layout)
-    local _, logical = self._private.layout:get_pixel_extents()
+    local entry = get_layout(self, Pango.units_from_double(width),
+        Pango.units_from_double(height), context.dpi)
+    cr:update_layout(entry.layout)
+    measure_entry(entry)
     local offset = 0
     if self._private.valign == "center" then
-        offset = (height - logical.height) / 2
+        offset = (height - entry.height) / 2
     elseif self._private.valign == "bottom" then
-        offset = height - logical.height
+        offset = height - entry.height
     end
     cr:move_to(0, offset)
-    cr:show_layout(self._private.layout)
+    cr:show_layout(entry.layout)
 end
 
-local function do_fit_return(self)
-    local _, logical = self._private.layout:get_pixel_extents()
-    if logical.width == 0 or logical.height == 0 then
+local function do_fit_return(entry)
+    if entry.width == 0 or entry.height == 0 then
         return 0, 0
     end
-    return logical.width, logical.height
+    return entry.width, entry.height
 end
 
 -- Fit the given textbox
 function textbox:fit(context, width, height)
-    setup_layout(self, width, height, context.dpi)
-    return do_fit_return(self)
+    return do_fit_return(get_layout(self, Pango.units_from_double(width),
+        Pango.units_from_double(height), context.dpi))
 end
 
 --- Get the preferred size of a textbox.
@@ -93,11 +192,8 @@ end
 -- @treturn number The preferred width.
 -- @treturn number The preferred height.
 function textbox:get_preferred_size_at_dpi(dpi)
-    local max_lines = 2^20
-    setup_dpi(self, dpi)
-    self._private.layout.width = -1 -- no width set
-    self._private.layout.height = -max_lines -- show this many lines per paragraph
-    return do_fit_return(self)
+    -- No width set, show this many lines per paragraph
+    return do_fit_return(get_layout(self, -1, -max_lines, dpi))
 end
 
 --- Get the preferred height of a textbox at a given width.
@@ -107,11 +203,8 @@ end
 -- @tparam number dpi The DPI value to render at.
 -- @treturn number The needed height.
 function textbox:get_height_for_width_at_dpi(width, dpi)
-    local max_lines = 2^20
-    setup_dpi(self, dpi)
-    self._private.layout.width = Pango.units_from_double(width)
-    self._private.layout.height = -max_lines -- show this many lines per paragraph
-    local _, h = do_fit_return(self)
+    -- Show this many lines per paragraph
+    local _, h = do_fit_return(get_layout(self, Pango.units_from_double(width), -max_lines, dpi))
     return h
 end
 
@@ -137,6 +230,7 @@ function textbox:set_markup_silently(text)
     self._private.markup = text
     self._private.layout.text = parsed
     self._private.layout.attributes = attr
+    update_content_key(self)
     self:emit_signal("widget::redraw_needed")
     self:emit_signal("widget::layout_changed")
     return true
@@ -173,6 +267,7 @@ function textbox:set_text(text)
     self._private.markup = nil
     self._private.layout.text = text
     self._private.layout.attributes = nil
+    update_content_key(self)
     self:emit_signal("widget::redraw_needed")
     self:emit_signal("widget::layout_changed")
 end
@@ -192,6 +287,7 @@ function textbox:set_ellipsize(mode)
             return
         end
         self._private.layout:set_ellipsize(allowed[mode])
+        update_content_key(self)
         self:emit_signal("widget::redraw_needed")
         self:emit_signal("widget::layout_changed")
     end
@@ -208,6 +304,7 @@ function textbox:set_wrap(mode)
             return
         end
         self._private.layout:set_wrap(allowed[mode])
+        update_content_key(self)
         self:emit_signal("widget::redraw_needed")
         self:emit_signal("widget::layout_changed")
     end
@@ -240,6 +337,7 @@ function textbox:set_align(mode)
             return
         end
         self._private.layout:set_alignment(allowed[mode])
+        update_content_key(self)
         self:emit_signal("widget::redraw_needed")
         self:emit_signal("widget::layout_changed")
     end
@@ -250,11 +348,72 @@ end
 -- @param font The font description as string
 
 function textbox:set_font(font)
-    self._private.layout:set_font_description(beautiful.get_font(font))
+    local desc = beautiful.get_font(font)
+    self._private.layout:set_font_description(desc)
+    self._private.font_name = desc:to_string()
+    update_content_key(self)
     self:emit_signal("widget::redraw_needed")
     self:emit_signal("widget::layout_changed")
 end
 
+-- Set up a layout for get_markup_geometry()
+local function fill_from_markup(layout, arg)
+    local attr, parsed = Pango.parse_markup(arg.markup, -1, 0)
+    layout:set_font_description(arg.font)
+    layout:set_ellipsize("END")
+    layout:set_wrap("WORD_CHAR")
+    layout:set_alignment("LEFT")
+    if attr then
+        layout.text = parsed
+        layout.attributes = attr
+    else
+        layout.text = arg.markup
+    end
+end
+
+--- Get the size that some markup needs without creating a textbox.
+-- This uses the same layout cache as the textboxes, so measuring the same text
+-- again is cheap.
+-- @tparam string text The markup to measure.
+-- @tparam[opt] integer|screen s The screen on which the text will be
+--   displayed.
+-- @tparam[opt=beautiful.font] string font The font description.
+-- @treturn table A table with `width` and `height` entries.
+function textbox.get_markup_geometry(text, s, font)
+    local dpi = beautiful.xresources.get_dpi(s)
+    local desc = beautiful.get_font(font or beautiful.font)
+    local font_name = desc:to_string()
+    local content_key = table.concat({ "m", text, font_name, "END", "WORD_CHAR", "LEFT" }, "\0")
+    local entry = get_cached_layout(content_key, -1, -max_lines, dpi,
+        fill_from_markup, { markup = text, font = desc })
+    local width, height = do_fit_return(entry)
+    return { width = width, height = height }
+end
+
+--- Get statistics about the layout cache shared by all textboxes.
+-- @treturn table A table with the number of `hits` and `misses`, the number
+--   of `entries` and the `max_entries` of each of the two generations.
+function textbox.get_layout_cache_stats()
+    local entries = layout_cache.size
+    for _ in pairs(layout_cache.old) do
+        entries = entries + 1
+    end
+    return {
+        hits = layout_cache.hits,
+        misses = layout_cache.misses,
+        entries = entries,
+        max_entries = layout_cache.max_size,
+    }
+end
+
+--- Set the number of entries per generation of the shared layout cache.
+-- At most twice this number of layouts are kept.
+-- @tparam integer size The new size.
+function textbox.set_layout_cache_size(size)
+    layout_cache.max_size = size
+    layout_cache.current, layout_cache.old, layout_cache.size = {}, {}, 0
+end
+
 --- Create a new textbox.
 -- @tparam[opt=""] string text The textbox content
 -- @tparam[opt=false] boolean ignore_markup Ignore the pango/HTML markup
@@ -265,9 +424,9 @@ local function new(text, ignore_markup)
 
     gtable.crush(ret, textbox, true)
 
-    ret._private.dpi = -1
-    ret._private.ctx = PangoCairo.font_map_get_default():create_context()
-    ret._private.layout = Pango.Layout.new(ret._private.ctx)
+    -- This layout only stores the content, drawing uses the layout cache
+    ret._private.layout = Pango.Layout.new(content_context)
+    update_content_key(ret)
 
     ret:set_ellipsize("end")
     ret:set_wrap("word_char")
@@ -35,11 +35,13 @@
 #include "common/version.h"
 #include "config.h"
 #include "event.h"
+#include "image.h"
 #include "objects/client.h"
 #include "objects/drawable.h"
 #include "objects/drawin.h"
 #include "objects/screen.h"
 #include "objects/tag.h"
+#include "pixmap.h"
 #include "property.h"
 #include "selection.h"
 #include "spawn.h"
@@ -269,9 +271,174 @@ luaA_sync(lua_State *L)
     return 0;
 }
 
+/** Get counters about the work done by awesome internally. This is meant for
+ * the test suite and benchmarks; the available fields may change at any time.
+ *
+ * The table contains a `refresh` table with the number of main loop refreshes
+ * (`count`) and the number of drawins (`drawins`), clients (`clients`) and
+ * borders (`borders`) that had pending changes applied by them.
+ *
+ * The `stack` table has the number of times the stacking order was recomputed
+ * (`count`), the number of restacking requests sent in total (`requests`) and
+ * the number of requests sent by the last recomputation (`last_requests`).
+ *
+ * The `ewmh` table has the number of EWMH properties on the root window that
+ * were written (`updates`) and of writes skipped because the value did not
+ * change (`skipped`).
+ *
+ * The `banning` table has the number of times banning was recomputed
+ * (`count`), the number of clients that were checked in total (`clients`) and
+ * the number of clients checked by the last recomputation (`last_clients`).
+ *
+ * The `startup` table has the number of existing windows that were adopted
+ * when awesome started (`windows`), the time this took in seconds (`time`) and
+ * the resulting number of windows adopted per second (`rate`).
+ *
+ * The `icons` table has the number of distinct client icons (`count`), the
+ * number of client references to them (`references`), the bytes used by
+ * their raw data (`raw_bytes`), the number of them that were decoded for
+ * drawing (`decoded`) and the bytes used by the decoded surfaces
+ * (`decoded_bytes`).
+ *
+ * The `wallpaper` table has the number of times the wallpaper was set
+ * (`count`), how often a whole new wallpaper pixmap had to be created for this
+ * (`full`) and the number of wallpaper pixels that were repainted (`pixels`).
+ *
+ * The `pixmaps` table has the number of drawable pixmaps that were recycled
+ * (`hits`) or had to be created (`misses`), the number of unused pixmaps that
+ * were freed because of the pool limit (`evictions`) and the memory used by
+ * the unused pixmaps in the pool (`bytes`).
+ *
+ * The `drawables` table has the number of rectangles copied from drawables to
+ * the screen (`copies`), the number of bytes this copied (`bytes`) and the
+ * number of bytes copied per second during the last second
+ * (`bytes_per_second`).
+ *
+ * The `images` table has the number of images that were loaded from the cache
+ * of decoded images (`hits`) or had to be decoded (`misses`), the number of
+ * images dropped because of the memory budget (`evictions`), the number of
+ * images in the cache (`count`) and the memory they use (`bytes`).
+ *
+ * @treturn table The counters.
+ * @function stats
+ */
+static int
+luaA_stats(lua_State *L)
+{
+    lua_createtable(L, 0, 11);
+
+    lua_createtable(L, 0, 4);
+    lua_pushinteger(L, globalconf.stats.refresh);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.refresh_drawins);
+    lua_setfield(L, -2, "drawins");
+    lua_pushinteger(L, globalconf.stats.refresh_clients);
+    lua_setfield(L, -2, "clients");
+    lua_pushinteger(L, globalconf.stats.refresh_borders);
+    lua_setfield(L, -2, "borders");
+    lua_setfield(L, -2, "refresh");
+
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, globalconf.stats.stack_refresh);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.stack_requests);
+    lua_setfield(L, -2, "requests");
+    lua_pushinteger(L, globalconf.stats.stack_last_requests);
+    lua_setfield(L, -2, "last_requests");
+    lua_setfield(L, -2, "stack");
+
+    lua_createtable(L, 0, 2);
+    lua_pushinteger(L, globalconf.stats.ewmh_updates);
+    lua_setfield(L, -2, "updates");
+    lua_pushinteger(L, globalconf.stats.ewmh_skipped);
+    lua_setfield(L, -2, "skipped");
+    lua_setfield(L, -2, "ewmh");
+
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, globalconf.stats.banning_refresh);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.banning_clients);
+    lua_setfield(L, -2, "clients");
+    lua_pushinteger(L, globalconf.stats.banning_last_clients);
+    lua_setfield(L, -2, "last_clients");
+    lua_setfield(L, -2, "banning");
+
+    double startup_time = globalconf.stats.startup_scan_usec / 1e6;
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, globalconf.stats.startup_windows);
+    lua_setfield(L, -2, "windows");
+    lua_pushnumber(L, startup_time);
+    lua_setfield(L, -2, "time");
+    lua_pushnumber(L, startup_time > 0 ? globalconf.stats.startup_windows / startup_time : 0);
+    lua_setfield(L, -2, "rate");
+    lua_setfield(L, -2, "startup");
+
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, globalconf.stats.icons);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.icon_references);
+    lua_setfield(L, -2, "references");
+    lua_pushinteger(L, globalconf.stats.icon_raw_bytes);
+    lua_setfield(L, -2, "raw_bytes");
+    lua_pushinteger(L, globalconf.stats.icon_decoded);
+    lua_setfield(L, -2, "decoded");
+    lua_pushinteger(L, globalconf.stats.icon_decoded_bytes);
+    lua_setfield(L, -2, "decoded_bytes");
+    lua_setfield(L, -2, "icons");
+
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, globalconf.stats.wallpaper_updates);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.wallpaper_full);
+    lua_setfield(L, -2, "full");
+    lua_pushinteger(L, globalconf.stats.wallpaper_pixels);
+    lua_setfield(L, -2, "pixels");
+    lua_setfield(L, -2, "wallpaper");
+
+    lua_createtable(L, 0, 4);
+    lua_pushinteger(L, globalconf.stats.pixmap_hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushinteger(L, globalconf.stats.pixmap_misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushinteger(L, globalconf.stats.pixmap_evictions);
+    lua_setfield(L, -2, "evictions");
+    lua_pushinteger(L, globalconf.stats.pixmap_pool_bytes);
+    lua_setfield(L, -2, "bytes");
+    lua_setfield(L, -2, "pixmaps");
+
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, globalconf.stats.drawable_copies);
+    lua_setfield(L, -2, "copies");
+    lua_pushinteger(L, globalconf.stats.drawable_copy_bytes);
+    lua_setfield(L, -2, "bytes");
+    lua_pushinteger(L, drawable_copy_rate());
+    lua_setfield(L, -2, "bytes_per_second");
+    lua_setfield(L, -2, "drawables");
+
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, globalconf.stats.image_cache_hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushinteger(L, globalconf.stats.image_cache_misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushinteger(L, globalconf.stats.image_cache_evictions);
+    lua_setfield(L, -2, "evictions");
+    lua_pushinteger(L, globalconf.stats.image_cache_count);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, globalconf.stats.image_cache_bytes);
+    lua_setfield(L, -2, "bytes");
+    lua_setfield(L, -2, "images");
+
+    return 1;
+}
+
 /** Load an image from a given path.
+ *
+ * Decoded images are kept in a cache, so loading the same unchanged file again
+ * only copies its pixels.
  *
  * @param name The file name.
+ * @tparam[opt=false] boolean shared Return the cached image itself instead of
+ *   a copy. It must then not be modified.
  * @return[1] A cairo surface as light user datum.
  * @return[2] nil
  * @treturn[2] string Error message
@@ -282,7 +449,8 @@ luaA_load_image(lua_State *L)
 {
     GError *error = NULL;
     const char *filename = luaL_checkstring(L, 1);
-    cairo_surface_t *surface = draw_load_image(L, filename, &error);
+    bool shared = lua_toboolean(L, 2);
+    cairo_surface_t *surface = image_cache_load(L, filename, shared, &error);
     if (!surface) {
         lua_pushnil(L);
         lua_pushstring(L, error->message);
@@ -310,6 +478,64 @@ luaA_set_preferred_icon_size(lua_State *L)
     return 0;
 }
 
+/** Check that a function argument is a size in bytes.
+ * \param L The Lua VM state.
+ * \param n The index of the argument.
+ * \return The size.
+ */
+static size_t
+luaA_checksize(lua_State *L, int n)
+{
+    lua_Number d = luaL_checknumber(L, n);
+    if(d < 0 || d >= (lua_Number) SIZE_MAX)
+        luaA_rangerror(L, n, 0, SIZE_MAX);
+    if(d != (lua_Number) (size_t) d)
+        luaA_typerror(L, n, "integer");
+    return d;
+}
+
+/** Set the memory limit of the pool of unused drawable pixmaps.
+ *
+ * Drawables reuse pixmaps of a similar size instead of creating a new one
+ * every time they are resized. Unused pixmaps are freed when they need more
+ * memory than this limit. The default is 16 MiB.
+ *
+ * @tparam integer bytes The limit in bytes, 0 disables the pool.
+ * @function set_pixmap_pool_limit
+ */
+static int
+luaA_set_pixmap_pool_limit(lua_State *L)
+{
+    pixmap_pool_set_limit(luaA_checksize(L, 1));
+    return 0;
+}
+
+/** Set the memory budget of the cache of decoded images.
+ *
+ * The least recently loaded images are dropped from the cache when it needs
+ * more memory than this. The default is 32 MiB.
+ *
+ * @tparam integer bytes The budget in bytes, 0 disables the cache.
+ * @function set_image_cache_limit
+ */
+static int
+luaA_set_image_cache_limit(lua_State *L)
+{
+    image_cache_set_limit(luaA_checksize(L, 1));
+    return 0;
+}
+
+/** Drop all images from the cache of decoded images.
+ *
+ * @function purge_image_cache
+ */
+static int
+luaA_purge_image_cache(lua_State *L)
+{
+    image_cache_purge();
+    return 0;
+}
+
 /** UTF-8 aware string length computing.
  * \param L The Lua VM state.
  * \return The number of elements pushed on stack.
@@ -486,9 +712,9 @@ luaA_awesome_index(lua_State *L)
 static int
 luaA_awesome_connect_signal(lua_State *L)
 {
-    const char *name = luaL_checkstring(L, 1);
+    signal_id_t id = luaA_checksignal(L, 1);
     luaA_checkfunction(L, 2);
-    signal_connect(&global_signals, name, luaA_object_ref(L, 2));
+    signal_connect(&global_signals, id, luaA_object_ref(L, 2));
     return 0;
 }
 
@@ -501,10 +727,10 @@ luaA_awesome_connect_signal(lua_State *L)
 static int
 luaA_awesome_disconnect_signal(lua_State *L)
 {
-    const char *name = luaL_checkstring(L, 1);
+    signal_id_t id = luaA_lookupsignal(L, 1);
     luaA_checkfunction(L, 2);
     const void *func = lua_topointer(L, 2);
-    if (signal_disconnect(&global_signals, name, func))
+    if (signal_disconnect(&global_signals, id, func))
         luaA_object_unref(L, (void *) func);
     return 0;
 }
@@ -518,7 +744,10 @@ luaA_awesome_disconnect_signal(lua_State *L)
 static int
 luaA_awesome_emit_signal(lua_State *L)
 {
-    signal_object_emit(L, &global_signals, luaL_checkstring(L, 1), lua_gettop(L) - 1);
+    signal_id_t id = luaA_lookupsignal(L, 1);
+    /* Nobody ever connected to this name */
+    if(id)
+        signal_object_emit(L, &global_signals, id, lua_gettop(L) - 1);
     return 0;
 }
 
@@ -587,7 +816,7 @@ luaA_dofunction_on_error(lua_State *L)
     /* duplicate string error */
     lua_pushvalue(L, -1);
     /* emit error signal */
-    signal_object_emit(L, &global_signals, "debug::error", 1);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("debug::error"), 1);
 
     if(!luaL_dostring(L, "return debug.traceback(\"error while running function!\", 3)"))
     {
@@ -765,6 +994,9 @@ luaA_init(xdgHandle* xdg, string_array_t *searchpath)
         { "systray", luaA_systray },
         { "load_image", luaA_load_image },
         { "set_preferred_icon_size", luaA_set_preferred_icon_size },
+        { "set_pixmap_pool_limit", luaA_set_pixmap_pool_limit },
+        { "set_image_cache_limit", luaA_set_image_cache_limit },
+        { "purge_image_cache", luaA_purge_image_cache },
         { "register_xproperty", luaA_register_xproperty },
         { "set_xproperty", luaA_set_xproperty },
         { "get_xproperty", luaA_get_xproperty },
@@ -776,6 +1008,7 @@ luaA_init(xdgHandle* xdg, string_array_t *searchpath)
         { "xrdb_get_value", luaA_xrdb_get_value},
         { "kill", luaA_kill},
         { "sync", luaA_sync},
+        { "stats", luaA_stats},
         { NULL, NULL }
     };
 
@@ -963,14 +1196,14 @@ luaA_find_config(xdgHandle* xdg, const char *confpatharg, luaA_config_callback *
 int
 luaA_class_index_miss_property(lua_State *L, lua_object_t *obj)
 {
-    signal_object_emit(L, &global_signals, "debug::index::miss", 2);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("debug::index::miss"), 2);
     return 0;
 }
 
 int
 luaA_class_newindex_miss_property(lua_State *L, lua_object_t *obj)
 {
-    signal_object_emit(L, &global_signals, "debug::newindex::miss", 3);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("debug::newindex::miss"), 3);
     return 0;
 }
 
@@ -978,14 +1211,14 @@ void
 luaA_emit_startup()
 {
     lua_State *L = globalconf_get_lua_State();
-    signal_object_emit(L, &global_signals, "startup", 0);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("startup"), 0);
 }
 
 void
 luaA_emit_refresh()
 {
     lua_State *L = globalconf_get_lua_State();
-    signal_object_emit(L, &global_signals, "refresh", 0);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("refresh"), 0);
 }
 
 int
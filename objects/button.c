@@ -136,7 +136,7 @@ static int
 luaA_button_set_modifiers(lua_State *L, button_t *b)
 {
     b->modifiers = luaA_tomodifiers(L, -1);
-    luaA_object_emit_signal(L, -3, "property::modifiers", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::modifiers"), 0);
     return 0;
 }
 
@@ -144,7 +144,7 @@ static int
 luaA_button_set_button(lua_State *L, button_t *b)
 {
     b->button = luaL_checkinteger(L, -1);
-    luaA_object_emit_signal(L, -3, "property::button", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::button"), 0);
     return 0;
 }
 
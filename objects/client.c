@@ -839,7 +839,9 @@ client_wipe(client_t *c)
 {
     key_array_wipe(&c->keys);
     xcb_icccm_get_wm_protocols_reply_wipe(&c->protocols);
-    cairo_surface_array_wipe(&c->icons);
+    icon_array_wipe(&c->icons);
+    client_array_wipe(&c->transients);
+    bitset_wipe(&c->tags);
     p_delete(&c->machine);
     p_delete(&c->class);
     p_delete(&c->instance);
@@ -864,7 +866,7 @@ client_set_urgent(lua_State *L, int cidx, bool urgent)
     {
         c->urgent = urgent;
 
-        luaA_object_emit_signal(L, cidx, "property::urgent", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::urgent"), 0);
     }
 }
 
@@ -876,12 +878,11 @@ client_set_urgent(lua_State *L, int cidx, bool urgent)
         if(c->prop != value) \
         { \
             c->prop = value; \
-            luaA_object_emit_signal(L, cidx, "property::" #prop, 0); \
+            luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::" #prop), 0); \
         } \
     }
 DO_CLIENT_SET_PROPERTY(group_window)
 DO_CLIENT_SET_PROPERTY(type)
-DO_CLIENT_SET_PROPERTY(transient_for)
 DO_CLIENT_SET_PROPERTY(pid)
 DO_CLIENT_SET_PROPERTY(skip_taskbar)
 #undef DO_CLIENT_SET_PROPERTY
@@ -898,7 +899,7 @@ DO_CLIENT_SET_PROPERTY(skip_taskbar)
         } \
         p_delete(&c->prop); \
         c->prop = value; \
-        luaA_object_emit_signal(L, cidx, "property::" #signal, 0); \
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::" #signal), 0); \
     }
 #define DO_CLIENT_SET_STRING_PROPERTY(prop) \
         DO_CLIENT_SET_STRING_PROPERTY2(prop, prop)
@@ -910,6 +911,38 @@ DO_CLIENT_SET_STRING_PROPERTY(role)
 DO_CLIENT_SET_STRING_PROPERTY(machine)
 #undef DO_CLIENT_SET_STRING_PROPERTY
 
+/** Remove a client from the transients list of its parent.
+ * \param c The client.
+ */
+static void
+client_transient_detach(client_t *c)
+{
+    if(!c->transient_for)
+        return;
+
+    foreach(tc, c->transient_for->transients)
+        if(*tc == c)
+        {
+            client_array_remove(&c->transient_for->transients, tc);
+            break;
+        }
+}
+
+void
+client_set_transient_for(lua_State *L, int cidx, client_t *value)
+{
+    client_t *c = luaA_checkudata(L, cidx, &client_class);
+
+    if(c->transient_for != value)
+    {
+        client_transient_detach(c);
+        c->transient_for = value;
+        if(value)
+            client_array_append(&value->transients, c);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::transient_for"), 0);
+    }
+}
+
 void
 client_find_transient_for(client_t *c)
 {
@@ -943,9 +976,9 @@ client_set_class_instance(lua_State *L, int cidx, const char *class, const char
     p_delete(&c->class);
     p_delete(&c->instance);
     c->class = a_strdup(class);
-    luaA_object_emit_signal(L, cidx, "property::class", 0);
+    luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::class"), 0);
     c->instance = a_strdup(instance);
-    luaA_object_emit_signal(L, cidx, "property::instance", 0);
+    luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::instance"), 0);
 }
 
 /** Returns true if a client is tagged with one of the active tags.
@@ -955,14 +988,7 @@ client_set_class_instance(lua_State *L, int cidx, const char *class, const char
 bool
 client_on_selected_tags(client_t *c)
 {
-    if(c->sticky)
-        return true;
-
-    foreach(tag, globalconf.tags)
-        if(tag_get_selected(*tag) && is_client_tagged(c, *tag))
-            return true;
-
-    return false;
+    return c->sticky || bitset_intersects(&c->tags, &globalconf.selected_tags);
 }
 
 /** Get a client by its window.
@@ -972,21 +998,17 @@ client_on_selected_tags(client_t *c)
 client_t *
 client_getbywin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_ROLE_CLIENT);
 }
 
+/** Get a client by the window used for focusing it.
+ * \param w The no-focus window to find.
+ * \return A client pointer if found, NULL otherwise.
+ */
 client_t *
 client_getbynofocuswin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->nofocus_window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_ROLE_NOFOCUS);
 }
 
 /** Get a client by its frame window.
@@ -996,11 +1018,7 @@ client_getbynofocuswin(xcb_window_t w)
 client_t *
 client_getbyframewin(xcb_window_t w)
 {
-    foreach(c, globalconf.clients)
-        if((*c)->frame_window == w)
-            return *c;
-
-    return NULL;
+    return (client_t *) window_index_lookup(w, WINDOW_ROLE_FRAME);
 }
 
 /** Unfocus a client (internal).
@@ -1013,7 +1031,7 @@ client_unfocus_internal(client_t *c)
     globalconf.focus.client = NULL;
 
     luaA_object_push(L, c);
-    luaA_object_emit_signal(L, -1, "unfocus", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("unfocus"), 0);
     lua_pop(L, 1);
 }
 
@@ -1129,7 +1147,7 @@ client_focus_update(client_t *c)
     client_set_urgent(L, -1, false);
 
     if(focused_new)
-        luaA_object_emit_signal(L, -1, "focus", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("focus"), 0);
 
     lua_pop(L, 1);
 
@@ -1160,6 +1178,7 @@ client_get_nofocus_window(client_t *c)
                           0, NULL);
         xcb_map_window(globalconf.connection, c->nofocus_window);
         xwindow_grabkeys(c->nofocus_window, &c->keys);
+        window_index_add(c->nofocus_window, WINDOW_ROLE_NOFOCUS, (window_t *) c);
     }
     return c->nofocus_window;
 }
@@ -1197,21 +1216,28 @@ client_focus_refresh(void)
                         win, globalconf.timestamp);
 }
 
-static void
-client_border_refresh(void)
+/** Queue a client for getting its geometry applied in the next refresh.
+ * \param c The client.
+ */
+void
+client_geometry_need_update(client_t *c)
 {
-    foreach(c, globalconf.clients)
-        window_border_refresh((window_t *) *c);
+    if(c->geometry_need_update)
+        return;
+    c->geometry_need_update = true;
+    client_array_append(&globalconf.refresh.clients, c);
 }
 
 static void
 client_geometry_refresh(void)
 {
     bool ignored_enterleave = false;
-    foreach(_c, globalconf.clients)
+    foreach(_c, globalconf.refresh.clients)
     {
         client_t *c = *_c;
 
+        c->geometry_need_update = false;
+
         /* Compute the client window's and frame window's geometry */
         area_t geometry = c->geometry;
         area_t real_geometry = c->geometry;
@@ -1281,13 +1307,15 @@ client_geometry_refresh(void)
     }
     if (ignored_enterleave)
         client_restore_enterleave_events();
+
+    globalconf.stats.refresh_clients += globalconf.refresh.clients.len;
+    globalconf.refresh.clients.len = 0;
 }
 
 void
 client_refresh(void)
 {
     client_geometry_refresh();
-    client_border_refresh();
     client_focus_refresh();
 }
 
@@ -1329,69 +1357,138 @@ border_width_callback(client_t *c, uint16_t old_width, uint16_t new_width)
 }
 
 static void
-client_update_properties(lua_State *L, int cidx, client_t *c)
-{
-    /* get all hints */
-    xcb_get_property_cookie_t wm_normal_hints   = property_get_wm_normal_hints(c);
-    xcb_get_property_cookie_t wm_hints          = property_get_wm_hints(c);
-    xcb_get_property_cookie_t wm_transient_for  = property_get_wm_transient_for(c);
-    xcb_get_property_cookie_t wm_client_leader  = property_get_wm_client_leader(c);
-    xcb_get_property_cookie_t wm_client_machine = property_get_wm_client_machine(c);
-    xcb_get_property_cookie_t wm_window_role    = property_get_wm_window_role(c);
-    xcb_get_property_cookie_t net_wm_pid        = property_get_net_wm_pid(c);
-    xcb_get_property_cookie_t net_wm_icon       = property_get_net_wm_icon(c);
-    xcb_get_property_cookie_t wm_name           = property_get_wm_name(c);
-    xcb_get_property_cookie_t net_wm_name       = property_get_net_wm_name(c);
-    xcb_get_property_cookie_t wm_icon_name      = property_get_wm_icon_name(c);
-    xcb_get_property_cookie_t net_wm_icon_name  = property_get_net_wm_icon_name(c);
-    xcb_get_property_cookie_t wm_class          = property_get_wm_class(c);
-    xcb_get_property_cookie_t wm_protocols      = property_get_wm_protocols(c);
-    xcb_get_property_cookie_t opacity           = xwindow_get_opacity_unchecked(c->window);
-
+client_update_properties(lua_State *L, int cidx, client_t *c, client_manage_request_t *req)
+{
     /* update strut */
-    ewmh_process_client_strut(c);
+    ewmh_process_client_strut_reply(c, req->strut);
 
     /* Now process all replies */
-    property_update_wm_normal_hints(c, wm_normal_hints);
-    property_update_wm_hints(c, wm_hints);
-    property_update_wm_transient_for(c, wm_transient_for);
-    property_update_wm_client_leader(c, wm_client_leader);
-    property_update_wm_client_machine(c, wm_client_machine);
-    property_update_wm_window_role(c, wm_window_role);
-    property_update_net_wm_pid(c, net_wm_pid);
-    property_update_net_wm_icon(c, net_wm_icon);
-    property_update_wm_name(c, wm_name);
-    property_update_net_wm_name(c, net_wm_name);
-    property_update_wm_icon_name(c, wm_icon_name);
-    property_update_net_wm_icon_name(c, net_wm_icon_name);
-    property_update_wm_class(c, wm_class);
-    property_update_wm_protocols(c, wm_protocols);
-    window_set_opacity(L, cidx, xwindow_get_opacity_from_cookie(opacity));
+    property_update_wm_normal_hints(c, req->wm_normal_hints);
+    property_update_wm_hints(c, req->wm_hints);
+    property_update_wm_transient_for(c, req->wm_transient_for);
+    c->leader_window = req->leader_window;
+    property_update_wm_client_machine(c, req->wm_client_machine);
+    property_update_wm_window_role(c, req->wm_window_role);
+    property_update_net_wm_pid(c, req->net_wm_pid);
+    property_update_net_wm_icon(c, req->net_wm_icon);
+    property_update_wm_name(c, req->wm_name);
+    property_update_net_wm_name(c, req->net_wm_name);
+    property_update_wm_icon_name(c, req->wm_icon_name);
+    property_update_net_wm_icon_name(c, req->net_wm_icon_name);
+    property_update_wm_class(c, req->wm_class);
+    property_update_wm_protocols(c, req->wm_protocols);
+    window_set_opacity(L, cidx, xwindow_get_opacity_from_cookie(req->opacity));
+}
+
+/** Send all the requests needed to manage a window, without waiting for
+ * their replies.
+ * \param w The window.
+ * \param req Where to store the requests.
+ */
+void
+client_manage_prefetch(xcb_window_t w, client_manage_request_t *req)
+{
+    p_clear(req, 1);
+
+    req->kde_dockapp       = systray_iskdedockapp_unchecked(w);
+    /* If this is a new client that just has been launched, then request its
+     * startup id. */
+    req->startup_id        = xcb_get_property(globalconf.connection, false,
+                                              w, _NET_STARTUP_ID,
+                                              XCB_GET_PROPERTY_TYPE_ANY, 0, UINT_MAX);
+    req->wm_normal_hints   = property_get_wm_normal_hints(w);
+    req->wm_hints          = property_get_wm_hints(w);
+    req->wm_transient_for  = property_get_wm_transient_for(w);
+    req->wm_client_leader  = property_get_wm_client_leader(w);
+    req->wm_client_machine = property_get_wm_client_machine(w);
+    req->wm_window_role    = property_get_wm_window_role(w);
+    req->net_wm_pid        = property_get_net_wm_pid(w);
+    req->net_wm_icon       = property_get_net_wm_icon(w);
+    req->wm_name           = property_get_wm_name(w);
+    req->net_wm_name       = property_get_net_wm_name(w);
+    req->wm_icon_name      = property_get_wm_icon_name(w);
+    req->net_wm_icon_name  = property_get_net_wm_icon_name(w);
+    req->wm_class          = property_get_wm_class(w);
+    req->wm_protocols      = property_get_wm_protocols(w);
+    req->opacity           = xwindow_get_opacity_unchecked(w);
+    req->strut             = ewmh_client_strut_get_unchecked(w);
+    ewmh_client_get_hints_unchecked(w, req->ewmh_hints);
+}
+
+/** Get the startup id of a window from the requests sent by
+ * client_manage_prefetch(). GTK puts it on the client leader window instead,
+ * so this may send one more request without waiting for it.
+ * \param req The requests of the window.
+ */
+void
+client_manage_prefetch_startup_id(client_manage_request_t *req)
+{
+    xcb_get_property_reply_t *reply;
+    void *data;
+
+    reply = xcb_get_property_reply(globalconf.connection, req->startup_id, NULL);
+    req->startup_id_value = xutil_get_text_property_from_reply(reply);
+    p_delete(&reply);
+
+    reply = xcb_get_property_reply(globalconf.connection, req->wm_client_leader, NULL);
+    if(reply && reply->value_len && (data = xcb_get_property_value(reply)))
+        req->leader_window = *(xcb_window_t *) data;
+    p_delete(&reply);
+
+    if (req->startup_id_value == NULL && req->leader_window != XCB_NONE) {
+        /* GTK hides this property elsewhere. No idea why. */
+        req->leader_startup_id = xcb_get_property(globalconf.connection, false,
+                                                  req->leader_window, _NET_STARTUP_ID,
+                                                  XCB_GET_PROPERTY_TYPE_ANY, 0, UINT_MAX);
+        req->have_leader_startup_id = true;
+    }
+}
+
+/** Drop the requests of a window that will not be managed after all.
+ * \param req The requests, after client_manage_prefetch_startup_id() and
+ * the KDE dock application check.
+ */
+void
+client_manage_request_discard(client_manage_request_t *req)
+{
+    xcb_get_property_cookie_t pending[] =
+    {
+        req->wm_normal_hints, req->wm_hints,
+        req->wm_transient_for, req->wm_client_machine, req->wm_window_role,
+        req->net_wm_pid, req->net_wm_icon, req->wm_name, req->net_wm_name,
+        req->wm_icon_name, req->net_wm_icon_name, req->wm_class,
+        req->wm_protocols, req->opacity, req->strut,
+        req->ewmh_hints[0], req->ewmh_hints[1], req->ewmh_hints[2]
+    };
+
+    for(int i = 0; i < countof(pending); i++)
+        xcb_discard_reply(globalconf.connection, pending[i].sequence);
+    if(req->have_leader_startup_id)
+        xcb_discard_reply(globalconf.connection, req->leader_startup_id.sequence);
+    p_delete(&req->startup_id_value);
 }
 
 /** Manage a new client.
  * \param w The window.
  * \param wgeom Window geometry.
- * \param startup True if we are managing at startup time.
+ * \param wattr Window attributes.
+ * \param req The requests from client_manage_prefetch(), after
+ * client_manage_prefetch_startup_id().
  */
 void
-client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_attributes_reply_t *wattr)
+client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_attributes_reply_t *wattr,
+              client_manage_request_t *req)
 {
     lua_State *L = globalconf_get_lua_State();
     const uint32_t select_input_val[] = { CLIENT_SELECT_INPUT_EVENT_MASK };
 
-    if(systray_iskdedockapp(w))
+    if(systray_iskdedockapp_reply(req->kde_dockapp))
     {
+        client_manage_request_discard(req);
         systray_request_handle(w);
         return;
     }
 
-    /* If this is a new client that just has been launched, then request its
-     * startup id. */
-    xcb_get_property_cookie_t startup_id_q = xcb_get_property(globalconf.connection, false,
-                                                              w, _NET_STARTUP_ID,
-                                                              XCB_GET_PROPERTY_TYPE_ANY, 0, UINT_MAX);
-
     /* Make sure the window is automatically mapped if awesome exits or dies. */
     xcb_change_save_set(globalconf.connection, XCB_SET_MODE_INSERT, w);
     if (globalconf.have_shape)
@@ -1461,7 +1558,9 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
 
     /* Duplicate client and push it in client list */
     lua_pushvalue(L, -1);
-    client_array_push(&globalconf.clients, luaA_object_ref(L, -1));
+    client_array_push(&globalconf.clients, luaA_object_ref_class(L, -1, &client_class));
+    window_index_add(c->window, WINDOW_ROLE_CLIENT, (window_t *) c);
+    window_index_add(c->frame_window, WINDOW_ROLE_FRAME, (window_t *) c);
 
     /* Set the right screen */
     screen_client_moveto(c, screen_getbycoord(wgeom->x, wgeom->y), false);
@@ -1473,23 +1572,24 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
     c->geometry.y = wgeom->y;
     c->geometry.width = wgeom->width;
     c->geometry.height = wgeom->height;
+    client_geometry_need_update(c);
 
-    luaA_object_emit_signal(L, -1, "property::x", 0);
-    luaA_object_emit_signal(L, -1, "property::y", 0);
-    luaA_object_emit_signal(L, -1, "property::width", 0);
-    luaA_object_emit_signal(L, -1, "property::height", 0);
-    luaA_object_emit_signal(L, -1, "property::window", 0);
-    luaA_object_emit_signal(L, -1, "property::geometry", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::x"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::y"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::width"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::height"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::window"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::geometry"), 0);
 
     /* Set border width */
     window_set_border_width(L, -1, wgeom->border_width);
 
     /* we honor size hints by default */
     c->size_hints_honor = true;
-    luaA_object_emit_signal(L, -1, "property::size_hints_honor", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::size_hints_honor"), 0);
 
     /* update all properties */
-    client_update_properties(L, -1, c);
+    client_update_properties(L, -1, c, req);
 
     /* check if this is a TRANSIENT_FOR of another client */
     foreach(oc, globalconf.clients)
@@ -1497,7 +1597,7 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
             client_find_transient_for(*oc);
 
     /* Then check clients hints */
-    ewmh_client_check_hints(c);
+    ewmh_client_check_hints(c, req->ewmh_hints);
 
     /* Push client in stack */
     stack_client_push(c);
@@ -1505,19 +1605,13 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
     /* Put the window in normal state. */
     xwindow_set_state(c->window, XCB_ICCCM_WM_STATE_NORMAL);
 
-    /* Request our response */
-    xcb_get_property_reply_t *reply =
-        xcb_get_property_reply(globalconf.connection, startup_id_q, NULL);
     /* Say spawn that a client has been started, with startup id as argument */
-    char *startup_id = xutil_get_text_property_from_reply(reply);
-    p_delete(&reply);
+    char *startup_id = req->startup_id_value;
+    req->startup_id_value = NULL;
 
-    if (startup_id == NULL && c->leader_window != XCB_NONE) {
-        /* GTK hides this property elsewhere. No idea why. */
-        startup_id_q = xcb_get_property(globalconf.connection, false,
-                                        c->leader_window, _NET_STARTUP_ID,
-                                        XCB_GET_PROPERTY_TYPE_ANY, 0, UINT_MAX);
-        reply = xcb_get_property_reply(globalconf.connection, startup_id_q, NULL);
+    if (req->have_leader_startup_id) {
+        xcb_get_property_reply_t *reply =
+            xcb_get_property_reply(globalconf.connection, req->leader_startup_id, NULL);
         startup_id = xutil_get_text_property_from_reply(reply);
         p_delete(&reply);
     }
@@ -1525,10 +1619,10 @@ client_manage(xcb_window_t w, xcb_get_geometry_reply_t *wgeom, xcb_get_window_at
 
     spawn_start_notify(c, startup_id);
 
-    luaA_class_emit_signal(L, &client_class, "list", 0);
+    luaA_class_emit_signal(L, &client_class, SIGNAL_ID("list"), 0);
 
     /* client is still on top of the stack; emit signal */
-    luaA_object_emit_signal(L, -1, "manage", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("manage"), 0);
     /* pop client */
     lua_pop(L, 1);
 }
@@ -1684,27 +1778,30 @@ client_resize_do(client_t *c, area_t geometry)
     /* Also store geometry including border */
     area_t old_geometry = c->geometry;
     c->geometry = geometry;
+    client_geometry_need_update(c);
 
-    luaA_object_push(L, c);
     if (!AREA_EQUAL(old_geometry, geometry))
-        luaA_object_emit_signal(L, -1, "property::geometry", 0);
-    if (old_geometry.x != geometry.x || old_geometry.y != geometry.y)
     {
-        luaA_object_emit_signal(L, -1, "property::position", 0);
-        if (old_geometry.x != geometry.x)
-            luaA_object_emit_signal(L, -1, "property::x", 0);
-        else
-            luaA_object_emit_signal(L, -1, "property::y", 0);
-    }
-    if (old_geometry.width != geometry.width || old_geometry.height != geometry.height)
-    {
-        luaA_object_emit_signal(L, -1, "property::size", 0);
-        if (old_geometry.width != geometry.width)
-            luaA_object_emit_signal(L, -1, "property::width", 0);
-        else
-            luaA_object_emit_signal(L, -1, "property::height", 0);
+        luaA_object_push(L, c);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("property::geometry"), 0);
+        if (old_geometry.x != geometry.x || old_geometry.y != geometry.y)
+        {
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("property::position"), 0);
+            if (old_geometry.x != geometry.x)
+                luaA_object_emit_signal(L, -1, SIGNAL_ID("property::x"), 0);
+            else
+                luaA_object_emit_signal(L, -1, SIGNAL_ID("property::y"), 0);
+        }
+        if (old_geometry.width != geometry.width || old_geometry.height != geometry.height)
+        {
+            luaA_object_emit_signal(L, -1, SIGNAL_ID("property::size"), 0);
+            if (old_geometry.width != geometry.width)
+                luaA_object_emit_signal(L, -1, SIGNAL_ID("property::width"), 0);
+            else
+                luaA_object_emit_signal(L, -1, SIGNAL_ID("property::height"), 0);
+        }
+        lua_pop(L, 1);
     }
-    lua_pop(L, 1);
 
     screen_client_moveto(c, new_screen, false);
 
@@ -1797,7 +1894,7 @@ client_set_minimized(lua_State *L, int cidx, bool s)
     if(c->minimized != s)
     {
         c->minimized = s;
-        banning_need_update();
+        banning_client_need_update(c);
         if(s)
         {
             /* ICCCM: To transition from ICONIC to NORMAL state, the client
@@ -1844,7 +1941,7 @@ client_set_minimized(lua_State *L, int cidx, bool s)
         }
         if(strut_has_value(&c->strut))
             screen_update_workarea(c->screen);
-        luaA_object_emit_signal(L, cidx, "property::minimized", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::minimized"), 0);
     }
 }
 
@@ -1861,10 +1958,10 @@ client_set_hidden(lua_State *L, int cidx, bool s)
     if(c->hidden != s)
     {
         c->hidden = s;
-        banning_need_update();
+        banning_client_need_update(c);
         if(strut_has_value(&c->strut))
             screen_update_workarea(c->screen);
-        luaA_object_emit_signal(L, cidx, "property::hidden", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::hidden"), 0);
     }
 }
 
@@ -1881,10 +1978,10 @@ client_set_sticky(lua_State *L, int cidx, bool s)
     if(c->sticky != s)
     {
         c->sticky = s;
-        banning_need_update();
+        banning_client_need_update(c);
         if(strut_has_value(&c->strut))
             screen_update_workarea(c->screen);
-        luaA_object_emit_signal(L, cidx, "property::sticky", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::sticky"), 0);
     }
 }
 
@@ -1902,7 +1999,7 @@ client_set_focusable(lua_State *L, int cidx, bool s)
     {
         c->focusable = s;
         c->focusable_set = true;
-        luaA_object_emit_signal(L, cidx, "property::focusable", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::focusable"), 0);
     }
 }
 
@@ -1918,7 +2015,7 @@ client_unset_focusable(lua_State *L, int cidx)
     if(c->focusable_set)
     {
         c->focusable_set = false;
-        luaA_object_emit_signal(L, cidx, "property::focusable", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::focusable"), 0);
     }
 }
 
@@ -1943,10 +2040,13 @@ client_set_fullscreen(lua_State *L, int cidx, bool s)
             client_set_ontop(L, cidx, false);
         }
         int abs_cidx = luaA_absindex(L, cidx); \
-        lua_pushstring(L, "fullscreen");
         c->fullscreen = s;
-        luaA_object_emit_signal(L, abs_cidx, "request::geometry", 1);
-        luaA_object_emit_signal(L, abs_cidx, "property::fullscreen", 0);
+        if(luaA_object_has_listeners(&client_class, c, SIGNAL_ID("request::geometry")))
+        {
+            lua_pushstring(L, "fullscreen");
+            luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("request::geometry"), 1);
+        }
+        luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("property::fullscreen"), 0);
         /* Force a client resize, so that titlebars get shown/hidden */
         client_resize_do(c, c->geometry);
         stack_windows();
@@ -1989,16 +2089,19 @@ client_set_maximized_common(lua_State *L, int cidx, bool s, const char* type, co
 
 
         /* Request the changes to be applied */
-        lua_pushstring(L, type);
-        luaA_object_emit_signal(L, abs_cidx, "request::geometry", 1);
+        if(luaA_object_has_listeners(&client_class, c, SIGNAL_ID("request::geometry")))
+        {
+            lua_pushstring(L, type);
+            luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("request::geometry"), 1);
+        }
 
         /* Notify changes in the relevant properties */
         if (h_before != c->maximized_horizontal)
-            luaA_object_emit_signal(L, abs_cidx, "property::maximized_horizontal", 0);
+            luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("property::maximized_horizontal"), 0);
         if (v_before != c->maximized_vertical)
-            luaA_object_emit_signal(L, abs_cidx, "property::maximized_vertical", 0);
+            luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("property::maximized_vertical"), 0);
         if(max_before != c->maximized)
-            luaA_object_emit_signal(L, abs_cidx, "property::maximized", 0);
+            luaA_object_emit_signal(L, abs_cidx, SIGNAL_ID("property::maximized"), 0);
 
         stack_windows();
     }
@@ -2049,7 +2152,7 @@ client_set_above(lua_State *L, int cidx, bool s)
         }
         c->above = s;
         stack_windows();
-        luaA_object_emit_signal(L, cidx, "property::above", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::above"), 0);
     }
 }
 
@@ -2074,7 +2177,7 @@ client_set_below(lua_State *L, int cidx, bool s)
         }
         c->below = s;
         stack_windows();
-        luaA_object_emit_signal(L, cidx, "property::below", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::below"), 0);
     }
 }
 
@@ -2092,7 +2195,7 @@ client_set_modal(lua_State *L, int cidx, bool s)
     {
         c->modal = s;
         stack_windows();
-        luaA_object_emit_signal(L, cidx, "property::modal", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::modal"), 0);
     }
 }
 
@@ -2117,7 +2220,7 @@ client_set_ontop(lua_State *L, int cidx, bool s)
         }
         c->ontop = s;
         stack_windows();
-        luaA_object_emit_signal(L, cidx, "property::ontop", 0);
+        luaA_object_emit_signal(L, cidx, SIGNAL_ID("property::ontop"), 0);
     }
 }
 
@@ -2155,12 +2258,10 @@ client_unmanage(client_t *c, bool window_valid)
     lua_State *L = globalconf_get_lua_State();
 
     /* Reset transient_for attributes of windows that might be referring to us */
-    foreach(_tc, globalconf.clients)
-    {
-        client_t *tc = *_tc;
-        if(tc->transient_for == c)
-            tc->transient_for = NULL;
-    }
+    foreach(tc, c->transients)
+        (*tc)->transient_for = NULL;
+    c->transients.len = 0;
+    client_transient_detach(c);
 
     if(globalconf.focus.client == c)
         client_unfocus(c);
@@ -2172,15 +2273,28 @@ client_unmanage(client_t *c, bool window_valid)
             client_array_remove(&globalconf.clients, elem);
             break;
         }
+    window_index_remove(c->window, (window_t *) c);
+    window_index_remove(c->frame_window, (window_t *) c);
+    window_index_remove(c->nofocus_window, (window_t *) c);
+    if(c->geometry_need_update)
+        foreach(elem, globalconf.refresh.clients)
+            if(*elem == c)
+            {
+                client_array_remove(&globalconf.refresh.clients, elem);
+                c->geometry_need_update = false;
+                break;
+            }
+    window_border_forget((window_t *) c);
+    banning_client_forget(c);
     stack_client_remove(c);
     for(int i = 0; i < globalconf.tags.len; i++)
         untag_client(c, globalconf.tags.tab[i]);
 
     luaA_object_push(L, c);
-    luaA_object_emit_signal(L, -1, "unmanage", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("unmanage"), 0);
     lua_pop(L, 1);
 
-    luaA_class_emit_signal(L, &client_class, "list", 0);
+    luaA_class_emit_signal(L, &client_class, SIGNAL_ID("list"), 0);
 
     if(strut_has_value(&c->strut))
         screen_update_workarea(c->screen);
@@ -2243,7 +2357,7 @@ client_unmanage(client_t *c, bool window_valid)
     /* set client as invalid */
     c->window = XCB_NONE;
 
-    luaA_object_unref(L, c);
+    luaA_object_unref_class(L, c);
 }
 
 /** Kill a client via a WM_DELETE_WINDOW request or KillClient if not
@@ -2336,15 +2450,15 @@ luaA_client_isvisible(lua_State *L)
  * \param array Array of icons to set.
  */
 void
-client_set_icons(client_t *c, cairo_surface_array_t array)
+client_set_icons(client_t *c, icon_array_t array)
 {
-    cairo_surface_array_wipe(&c->icons);
+    icon_array_wipe(&c->icons);
     c->icons = array;
 
     lua_State *L = globalconf_get_lua_State();
     luaA_object_push(L, c);
-    luaA_object_emit_signal(L, -1, "property::icon", 0);
-    luaA_object_emit_signal(L, -1, "property::icon_sizes", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::icon"), 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("property::icon_sizes"), 0);
     lua_pop(L, 1);
 }
 
@@ -2356,10 +2470,10 @@ client_set_icons(client_t *c, cairo_surface_array_t array)
 static void
 client_set_icon(client_t *c, cairo_surface_t *s)
 {
-    cairo_surface_array_t array;
-    cairo_surface_array_init(&array);
+    icon_array_t array;
+    icon_array_init(&array);
     if (s && cairo_surface_status(s) == CAIRO_STATUS_SUCCESS)
-        cairo_surface_array_push(&array, draw_dup_image_surface(s));
+        icon_array_push(&array, icon_new_from_surface(draw_dup_image_surface(s)));
     client_set_icons(c, array);
 }
 
@@ -2467,16 +2581,16 @@ luaA_client_swap(lua_State *L)
         *ref_c = swap;
         *ref_swap = c;
 
-        luaA_class_emit_signal(L, &client_class, "list", 0);
+        luaA_class_emit_signal(L, &client_class, SIGNAL_ID("list"), 0);
 
         luaA_object_push(L, swap);
         lua_pushboolean(L, true);
-        luaA_object_emit_signal(L, -4, "swapped", 2);
+        luaA_object_emit_signal(L, -4, SIGNAL_ID("swapped"), 2);
 
         luaA_object_push(L, swap);
         luaA_object_push(L, c);
         lua_pushboolean(L, false);
-        luaA_object_emit_signal(L, -3, "swapped", 2);
+        luaA_object_emit_signal(L, -3, SIGNAL_ID("swapped"), 2);
     }
 
     return 0;
@@ -2531,7 +2645,7 @@ luaA_client_tags(lua_State *L)
 
         lua_pop(L, 1);
 
-        luaA_object_emit_signal(L, -1, "property::tags", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("property::tags"), 0);
     }
 
     lua_newtable(L);
@@ -2604,7 +2718,7 @@ luaA_client_lower(lua_State *L)
 
     /* Notify the listeners */
     luaA_object_push(L, c);
-    luaA_object_emit_signal(L, -1, "lowered", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("lowered"), 0);
     lua_pop(L, 1);
 
     return 0;
@@ -2711,10 +2825,11 @@ client_refresh_titlebar_partial(client_t *c, client_titlebar_t bar, int16_t x, i
 
 #define HANDLE_TITLEBAR_REFRESH(name, index)                                                \
 static void                                                                                 \
-client_refresh_titlebar_ ## name(client_t *c)                                               \
+client_refresh_titlebar_ ## name(client_t *c, int16_t x, int16_t y,                         \
+                                 uint16_t width, uint16_t height)                           \
 {                                                                                           \
     area_t area = titlebar_get_area(c, index);                                              \
-    client_refresh_titlebar_partial(c, index, area.x, area.y, area.width, area.height);     \
+    client_refresh_titlebar_partial(c, index, area.x + x, area.y + y, width, height);       \
 }
 HANDLE_TITLEBAR_REFRESH(top, CLIENT_TITLEBAR_TOP)
 HANDLE_TITLEBAR_REFRESH(right, CLIENT_TITLEBAR_RIGHT)
@@ -2722,13 +2837,25 @@ HANDLE_TITLEBAR_REFRESH(bottom, CLIENT_TITLEBAR_BOTTOM)
 HANDLE_TITLEBAR_REFRESH(left, CLIENT_TITLEBAR_LEFT)
 
 /**
- * Refresh all titlebars that are in the specified rectangle
+ * Refresh all titlebars that are in the specified rectangle during the next
+ * refresh.
  */
 void
 client_refresh_partial(client_t *c, int16_t x, int16_t y, uint16_t width, uint16_t height)
 {
     for (client_titlebar_t bar = CLIENT_TITLEBAR_TOP; bar < CLIENT_TITLEBAR_COUNT; bar++) {
-        client_refresh_titlebar_partial(c, bar, x, y, width, height);
+        if (c->titlebar[bar].drawable == NULL)
+            continue;
+
+        /* Damage the part of the titlebar that is in the rectangle */
+        area_t area = titlebar_get_area(c, bar);
+        int x1 = MAX(x, AREA_LEFT(area));
+        int y1 = MAX(y, AREA_TOP(area));
+        int x2 = MIN(x + width, AREA_RIGHT(area));
+        int y2 = MIN(y + height, AREA_BOTTOM(area));
+        if (x2 > x1 && y2 > y1)
+            drawable_add_damage(c->titlebar[bar].drawable,
+                                x1 - area.x, y1 - area.y, x2 - x1, y2 - y1);
     }
 }
 
@@ -2763,7 +2890,7 @@ titlebar_get_drawable(lua_State *L, client_t *c, int cl_idx, client_titlebar_t b
 static void
 titlebar_resize(lua_State *L, int cidx, client_t *c, client_titlebar_t bar, int size)
 {
-    const char *property_name;
+    signal_id_t property_name;
 
     if (size < 0)
         return;
@@ -2780,22 +2907,22 @@ titlebar_resize(lua_State *L, int cidx, client_t *c, client_titlebar_t bar, int
     case CLIENT_TITLEBAR_TOP:
         geometry.height += change;
         diff_top = change;
-        property_name = "property::titlebar_top";
+        property_name = SIGNAL_ID("property::titlebar_top");
         break;
     case CLIENT_TITLEBAR_BOTTOM:
         geometry.height += change;
         diff_bottom = change;
-        property_name = "property::titlebar_bottom";
+        property_name = SIGNAL_ID("property::titlebar_bottom");
         break;
     case CLIENT_TITLEBAR_RIGHT:
         geometry.width += change;
         diff_right = change;
-        property_name = "property::titlebar_right";
+        property_name = SIGNAL_ID("property::titlebar_right");
         break;
     case CLIENT_TITLEBAR_LEFT:
         geometry.width += change;
         diff_left = change;
-        property_name = "property::titlebar_left";
+        property_name = SIGNAL_ID("property::titlebar_left");
         break;
     default:
         fatal("Unknown titlebar kind %d\n", (int) bar);
@@ -2990,7 +3117,7 @@ static int
 luaA_client_set_size_hints_honor(lua_State *L, client_t *c)
 {
     c->size_hints_honor = luaA_checkboolean(L, -1);
-    luaA_object_emit_signal(L, -3, "property::size_hints_honor", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::size_hints_honor"), 0);
     return 0;
 }
 
@@ -3109,14 +3236,14 @@ luaA_client_get_icon(lua_State *L, client_t *c)
     /* Pick the closest available size, only picking a smaller icon if no bigger
      * one is available.
      */
-    cairo_surface_t *found = NULL;
+    icon_t *found = NULL;
     int found_size = 0;
     int preferred_size = globalconf.preferred_icon_size;
 
-    foreach(surf, c->icons)
+    foreach(icon, c->icons)
     {
-        int width = cairo_image_surface_get_width(*surf);
-        int height = cairo_image_surface_get_height(*surf);
+        int width = (*icon)->width;
+        int height = (*icon)->height;
         int size = MAX(width, height);
 
         /* pick the icon if it's a better match than the one we already have */
@@ -3128,13 +3255,13 @@ luaA_client_get_icon(lua_State *L, client_t *c)
             size >= preferred_size && size < found_size;
         if (!icon_empty && (better_because_bigger || better_because_smaller || found_size == 0))
         {
-            found = *surf;
+            found = *icon;
             found_size = size;
         }
     }
 
     /* lua gets its own reference which it will have to destroy */
-    lua_pushlightuserdata(L, cairo_surface_reference(found));
+    lua_pushlightuserdata(L, found ? cairo_surface_reference(icon_get_surface(found)) : NULL);
     return 1;
 }
 
@@ -3327,7 +3454,7 @@ luaA_client_set_shape_bounding(lua_State *L, client_t *c)
             c->geometry.width + (c->border_width * 2),
             c->geometry.height + (c->border_width * 2),
             XCB_SHAPE_SK_BOUNDING, surf, -c->border_width);
-    luaA_object_emit_signal(L, -3, "property::shape_bounding", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_bounding"), 0);
     return 0;
 }
 
@@ -3376,7 +3503,7 @@ luaA_client_set_shape_clip(lua_State *L, client_t *c)
         surf = (cairo_surface_t *)lua_touserdata(L, -1);
     xwindow_set_shape(c->frame_window, c->geometry.width, c->geometry.height,
             XCB_SHAPE_SK_CLIP, surf, 0);
-    luaA_object_emit_signal(L, -3, "property::shape_clip", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_clip"), 0);
     return 0;
 }
 
@@ -3411,7 +3538,7 @@ luaA_client_set_shape_input(lua_State *L, client_t *c)
             c->geometry.width + (c->border_width * 2),
             c->geometry.height + (c->border_width * 2),
             XCB_SHAPE_SK_INPUT, surf, -c->border_width);
-    luaA_object_emit_signal(L, -3, "property::shape_input", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_input"), 0);
     return 0;
 }
 
@@ -3430,7 +3557,7 @@ luaA_client_keys(lua_State *L)
     if(lua_gettop(L) == 2)
     {
         luaA_key_array_set(L, 1, 2, keys);
-        luaA_object_emit_signal(L, 1, "property::keys", 0);
+        luaA_object_emit_signal(L, 1, SIGNAL_ID("property::keys"), 0);
         xwindow_grabkeys(c->window, keys);
         if (c->nofocus_window)
             xwindow_grabkeys(c->nofocus_window, &c->keys);
@@ -3446,14 +3573,14 @@ luaA_client_get_icon_sizes(lua_State *L)
     client_t *c = luaA_checkudata(L, 1, &client_class);
 
     lua_newtable(L);
-    foreach (s, c->icons) {
+    foreach (icon, c->icons) {
         /* Create a table { width, height } and append it to the table */
         lua_createtable(L, 2, 0);
 
-        lua_pushinteger(L, cairo_image_surface_get_width(*s));
+        lua_pushinteger(L, (*icon)->width);
         lua_rawseti(L, -2, 1);
 
-        lua_pushinteger(L, cairo_image_surface_get_height(*s));
+        lua_pushinteger(L, (*icon)->height);
         lua_rawseti(L, -2, 2);
 
         lua_rawseti(L, -2, index++);
@@ -3479,7 +3606,7 @@ luaA_client_get_some_icon(lua_State *L)
     int index = luaL_checkinteger(L, 2);
     luaL_argcheck(L, (index >= 1 && index <= c->icons.len), 2,
             "invalid icon index");
-    lua_pushlightuserdata(L, cairo_surface_reference(c->icons.tab[index-1]));
+    lua_pushlightuserdata(L, cairo_surface_reference(icon_get_surface(c->icons.tab[index-1])));
     return 1;
 }
 
@@ -23,6 +23,8 @@
 #define AWESOME_OBJECTS_CLIENT_H
 
 #include "stack.h"
+#include "common/bitset.h"
+#include "icon.h"
 #include "objects/window.h"
 
 #define CLIENT_SELECT_INPUT_EVENT_MASK (XCB_EVENT_MASK_STRUCTURE_NOTIFY \
@@ -66,6 +68,10 @@ struct client_t
     area_t x11_frame_geometry;
     /** Got a configure request and have to call client_send_configure() if its ignored? */
     bool got_configure_request;
+    /** Is this client queued for client_geometry_refresh()? */
+    bool geometry_need_update;
+    /** Is this client queued for banning_refresh()? */
+    bool banning_need_update;
     /** Startup ID */
     char *startup_id;
     /** True if the client is sticky */
@@ -117,7 +123,7 @@ struct client_t
     /** Key bindings */
     key_array_t keys;
     /** Icons */
-    cairo_surface_array_t icons;
+    icon_array_t icons;
     /** True if we ever got an icon from _NET_WM_ICON */
     bool have_ewmh_icon;
     /** Size hints */
@@ -136,6 +142,12 @@ struct client_t
     client_t *transient_for;
     /** Value of WM_TRANSIENT_FOR */
     xcb_window_t transient_for_window;
+    /** Clients which are transient for this one */
+    client_array_t transients;
+    /** Tags of this client, indexed by tag_t.bit */
+    bitset_t tags;
+    /** Index in globalconf.stack, updated by stack_refresh() */
+    int stack_position;
     /** Titelbar information */
     struct {
         /** The size of this bar. */
@@ -147,6 +159,40 @@ struct client_t
 
 ARRAY_FUNCS(client_t *, client, DO_NOTHING)
 
+/** The requests whose replies client_manage() needs. They are sent ahead of
+ * time by client_manage_prefetch(), so that many windows can be managed with
+ * a few round trips in total instead of a few per window.
+ */
+typedef struct
+{
+    xcb_get_property_cookie_t kde_dockapp;
+    xcb_get_property_cookie_t startup_id;
+    xcb_get_property_cookie_t wm_normal_hints;
+    xcb_get_property_cookie_t wm_hints;
+    xcb_get_property_cookie_t wm_transient_for;
+    xcb_get_property_cookie_t wm_client_leader;
+    xcb_get_property_cookie_t wm_client_machine;
+    xcb_get_property_cookie_t wm_window_role;
+    xcb_get_property_cookie_t net_wm_pid;
+    xcb_get_property_cookie_t net_wm_icon;
+    xcb_get_property_cookie_t wm_name;
+    xcb_get_property_cookie_t net_wm_name;
+    xcb_get_property_cookie_t wm_icon_name;
+    xcb_get_property_cookie_t net_wm_icon_name;
+    xcb_get_property_cookie_t wm_class;
+    xcb_get_property_cookie_t wm_protocols;
+    xcb_get_property_cookie_t opacity;
+    xcb_get_property_cookie_t strut;
+    xcb_get_property_cookie_t ewmh_hints[3];
+    /** The startup id, filled by client_manage_prefetch_startup_id() */
+    char *startup_id_value;
+    /** The client leader, filled by client_manage_prefetch_startup_id() */
+    xcb_window_t leader_window;
+    /** The startup id request on the client leader, if one was sent */
+    xcb_get_property_cookie_t leader_startup_id;
+    bool have_leader_startup_id;
+} client_manage_request_t;
+
 /** Client class */
 lua_class_t client_class;
 
@@ -160,7 +206,10 @@ client_t * client_getbyframewin(xcb_window_t);
 void client_ban(client_t *);
 void client_ban_unfocus(client_t *);
 void client_unban(client_t *);
-void client_manage(xcb_window_t, xcb_get_geometry_reply_t *, xcb_get_window_attributes_reply_t *);
+void client_manage_prefetch(xcb_window_t, client_manage_request_t *);
+void client_manage_prefetch_startup_id(client_manage_request_t *);
+void client_manage_request_discard(client_manage_request_t *);
+void client_manage(xcb_window_t, xcb_get_geometry_reply_t *, xcb_get_window_attributes_reply_t *, client_manage_request_t *);
 bool client_resize(client_t *, area_t, bool);
 void client_unmanage(client_t *, bool);
 void client_kill(client_t *);
@@ -186,7 +235,7 @@ void client_set_transient_for(lua_State *L, int, client_t *);
 void client_set_name(lua_State *L, int, char *);
 void client_set_alt_name(lua_State *L, int, char *);
 void client_set_group_window(lua_State *, int, xcb_window_t);
-void client_set_icons(client_t *, cairo_surface_array_t);
+void client_set_icons(client_t *, icon_array_t);
 void client_set_icon_from_pixmaps(client_t *, xcb_pixmap_t, xcb_pixmap_t);
 void client_set_skip_taskbar(lua_State *, int, bool);
 void client_focus(client_t *);
@@ -197,6 +246,7 @@ void client_restore_enterleave_events(void);
 void client_refresh_partial(client_t *, int16_t, int16_t, uint16_t, uint16_t);
 void client_class_setup(lua_State *);
 void client_send_configure(client_t *);
+void client_geometry_need_update(client_t *);
 void client_find_transient_for(client_t *);
 drawable_t *client_get_drawable(client_t *, int, int);
 drawable_t *client_get_drawable_offset(client_t *, int *, int *);
@@ -229,7 +279,7 @@ client_raise(client_t *c)
     /* Notify the listeners */
     lua_State *L = globalconf_get_lua_State();
     luaA_object_push(L, c);
-    luaA_object_emit_signal(L, -1, "raised", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("raised"), 0);
     lua_pop(L, 1);
 }
 
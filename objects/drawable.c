@@ -33,8 +33,10 @@
 #include "drawable.h"
 #include "common/luaobject.h"
 #include "globalconf.h"
+#include "pixmap.h"
 
 #include <cairo-xcb.h>
+#include <math.h>
 
 /** Drawable object.
  *
@@ -102,7 +104,7 @@
  * @function set_newindex_miss_handler
  */
 
-static lua_class_t drawable_class;
+lua_class_t drawable_class;
 
 LUA_OBJECT_FUNCS(drawable_class, drawable_t, drawable)
 
@@ -115,6 +117,7 @@ drawable_allocator(lua_State *L, drawable_refresh_callback *callback, void *data
     d->refreshed = false;
     d->surface = NULL;
     d->pixmap = XCB_NONE;
+    d->damage = NULL;
     return d;
 }
 
@@ -124,49 +127,158 @@ drawable_unset_surface(drawable_t *d)
     cairo_surface_finish(d->surface);
     cairo_surface_destroy(d->surface);
     if (d->pixmap)
-        xcb_free_pixmap(globalconf.connection, d->pixmap);
+        pixmap_pool_put(d->pixmap, globalconf.default_depth,
+                        d->geometry.width, d->geometry.height);
     d->refreshed = false;
     d->surface = NULL;
     d->pixmap = XCB_NONE;
 }
 
+/** Remove a drawable from the refresh queue, dropping its damage.
+ * \param d The drawable.
+ */
+static void
+drawable_forget_damage(drawable_t *d)
+{
+    if (!d->damage)
+        return;
+    cairo_region_destroy(d->damage);
+    d->damage = NULL;
+    foreach(elem, globalconf.refresh.drawables)
+        if(*elem == d)
+        {
+            drawable_array_remove(&globalconf.refresh.drawables, elem);
+            break;
+        }
+}
+
 static void
 drawable_wipe(drawable_t *d)
 {
+    drawable_forget_damage(d);
     drawable_unset_surface(d);
 }
 
+/** Mark a part of a drawable as needing to be copied to the screen. The copy
+ * happens during the next refresh, together with all other damage.
+ * \param d The drawable.
+ * \param x The x coordinate of the area, relative to the drawable.
+ * \param y The y coordinate of the area, relative to the drawable.
+ * \param width The width of the area.
+ * \param height The height of the area.
+ */
+void
+drawable_add_damage(drawable_t *d, int16_t x, int16_t y, uint16_t width, uint16_t height)
+{
+    cairo_rectangle_int_t rect = { x, y, width, height };
+
+    if (width == 0 || height == 0)
+        return;
+
+    if (!d->damage)
+    {
+        d->damage = cairo_region_create();
+        drawable_array_append(&globalconf.refresh.drawables, d);
+    }
+    cairo_region_union_rectangle(d->damage, &rect);
+}
+
+/** Start of the current measurement interval of drawable_copy_rate() */
+static int64_t copy_interval_start;
+/** Bytes copied during the current measurement interval */
+static uint64_t copy_interval_bytes;
+/** Bytes per second copied during the last full measurement interval */
+static uint64_t copy_rate;
+
+/** Get the number of bytes per second recently copied from drawables to the
+ * screen.
+ * \return The rate, measured over the last full second.
+ */
+uint64_t
+drawable_copy_rate(void)
+{
+    /* Nothing was copied for a while */
+    if (g_get_monotonic_time() - copy_interval_start >= 2 * G_USEC_PER_SEC)
+        return 0;
+    return copy_rate;
+}
+
+/** Copy the damaged parts of all drawables to the screen. */
+void
+drawable_refresh(void)
+{
+    uint64_t bytes = 0;
+
+    foreach(item, globalconf.refresh.drawables)
+    {
+        drawable_t *d = *item;
+        cairo_rectangle_int_t bounds = { 0, 0, d->geometry.width, d->geometry.height };
+
+        cairo_region_intersect_rectangle(d->damage, &bounds);
+        /* Surface contents are undefined until Lua refreshed them */
+        if (d->refreshed)
+            for (int i = 0; i < cairo_region_num_rectangles(d->damage); i++)
+            {
+                cairo_rectangle_int_t rect;
+                cairo_region_get_rectangle(d->damage, i, &rect);
+                (*d->refresh_callback)(d->refresh_data, rect.x, rect.y, rect.width, rect.height);
+                globalconf.stats.drawable_copies++;
+                bytes += (uint64_t) 4 * rect.width * rect.height;
+            }
+        cairo_region_destroy(d->damage);
+        d->damage = NULL;
+    }
+    globalconf.refresh.drawables.len = 0;
+
+    if (bytes == 0)
+        return;
+
+    int64_t now = g_get_monotonic_time();
+    if (now - copy_interval_start >= G_USEC_PER_SEC)
+    {
+        /* Finish the measurement interval, unless it was idle */
+        if (now - copy_interval_start < 2 * G_USEC_PER_SEC)
+            copy_rate = copy_interval_bytes * G_USEC_PER_SEC / (now - copy_interval_start);
+        else
+            copy_rate = 0;
+        copy_interval_start = now;
+        copy_interval_bytes = 0;
+    }
+    copy_interval_bytes += bytes;
+    globalconf.stats.drawable_copy_bytes += bytes;
+}
+
 void
 drawable_set_geometry(lua_State *L, int didx, area_t geom)
 {
     drawable_t *d = luaA_checkudata(L, didx, &drawable_class);
     area_t old = d->geometry;
-    d->geometry = geom;
 
     bool size_changed = (old.width != geom.width) || (old.height != geom.height);
     if (size_changed)
         drawable_unset_surface(d);
+    d->geometry = geom;
     if (size_changed && geom.width > 0 && geom.height > 0)
     {
-        d->pixmap = xcb_generate_id(globalconf.connection);
-        xcb_create_pixmap(globalconf.connection, globalconf.default_depth, d->pixmap,
-                          globalconf.screen->root, geom.width, geom.height);
+        /* The pixmap may be bigger than the drawable, only its top-left part
+         * is used. */
+        d->pixmap = pixmap_pool_get(globalconf.default_depth, geom.width, geom.height);
         d->surface = cairo_xcb_surface_create(globalconf.connection,
                                               d->pixmap, globalconf.visual,
                                               geom.width, geom.height);
-        luaA_object_emit_signal(L, didx, "property::surface", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::surface"), 0);
     }
 
     if (!AREA_EQUAL(old, geom))
-        luaA_object_emit_signal(L, didx, "property::geometry", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::geometry"), 0);
     if (old.x != geom.x)
-        luaA_object_emit_signal(L, didx, "property::x", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::x"), 0);
     if (old.y != geom.y)
-        luaA_object_emit_signal(L, didx, "property::y", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::y"), 0);
     if (old.width != geom.width)
-        luaA_object_emit_signal(L, didx, "property::width", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::width"), 0);
     if (old.height != geom.height)
-        luaA_object_emit_signal(L, didx, "property::height", 0);
+        luaA_object_emit_signal(L, didx, SIGNAL_ID("property::height"), 0);
 }
 
 /** Get a drawable's surface
@@ -188,6 +300,12 @@ luaA_drawable_get_surface(lua_State *L, drawable_t *drawable)
 /** Refresh a drawable's content. This has to be called whenever some drawing to
  * the drawable's surface has been done and should become visible.
  *
+ * The changed parts are copied to the screen during the next refresh,
+ * merged with all other changes to this drawable.
+ *
+ * @tparam[opt] table areas A list of tables with `x`, `y`, `width` and
+ *   `height` keys that describe the changed parts. Everything is refreshed if
+ *   this is not given.
  * @function refresh
  */
 static int
@@ -195,7 +313,33 @@ luaA_drawable_refresh(lua_State *L)
 {
     drawable_t *drawable = luaA_checkudata(L, 1, &drawable_class);
     drawable->refreshed = true;
-    (*drawable->refresh_callback)(drawable->refresh_data);
+
+    if (lua_isnoneornil(L, 2))
+    {
+        drawable_add_damage(drawable, 0, 0,
+                            drawable->geometry.width, drawable->geometry.height);
+        return 0;
+    }
+
+    luaA_checktable(L, 2);
+    for (size_t i = 1; i <= luaA_rawlen(L, 2); i++)
+    {
+        lua_rawgeti(L, 2, i);
+        luaA_checktable(L, -1);
+        /* Clip to the drawable, partially covered pixels are included */
+        int x1 = MAX(floor(luaA_getopt_number(L, -1, "x", 0)), 0);
+        int y1 = MAX(floor(luaA_getopt_number(L, -1, "y", 0)), 0);
+        int x2 = MIN(ceil(luaA_getopt_number(L, -1, "x", 0)
+                          + luaA_getopt_number(L, -1, "width", 0)),
+                     drawable->geometry.width);
+        int y2 = MIN(ceil(luaA_getopt_number(L, -1, "y", 0)
+                          + luaA_getopt_number(L, -1, "height", 0)),
+                     drawable->geometry.height);
+        lua_pop(L, 1);
+
+        if (x2 > x1 && y2 > y1)
+            drawable_add_damage(drawable, x1, y1, x2 - x1, y2 - y1);
+    }
 
     return 0;
 }
@@ -23,10 +23,12 @@
 #ifndef AWESOME_OBJECTS_DRAWABLE_H
 #define AWESOME_OBJECTS_DRAWABLE_H
 
+#include "globalconf.h"
 #include "common/luaclass.h"
 #include "draw.h"
 
-typedef void drawable_refresh_callback(void *);
+/** Callback that copies a part of a drawable to the screen */
+typedef void drawable_refresh_callback(void *, int16_t, int16_t, uint16_t, uint16_t);
 
 /** drawable type */
 struct drawable_t
@@ -40,6 +42,9 @@ struct drawable_t
     area_t geometry;
     /** Surface contents are undefined if this is false. */
     bool refreshed;
+    /** Part that has to be copied to the screen by the next refresh, or NULL
+     * if the drawable is not queued. */
+    cairo_region_t *damage;
     /** Callback for refreshing. */
     drawable_refresh_callback *refresh_callback;
     /** Data for refresh callback. */
@@ -47,8 +52,14 @@ struct drawable_t
 };
 typedef struct drawable_t drawable_t;
 
+lua_class_t drawable_class;
+
+ARRAY_FUNCS(drawable_t *, drawable, DO_NOTHING)
+
 drawable_t *drawable_allocator(lua_State *, drawable_refresh_callback *, void *);
 void drawable_set_geometry(lua_State *, int, area_t);
+void drawable_add_damage(drawable_t *, int16_t, int16_t, uint16_t, uint16_t);
+uint64_t drawable_copy_rate(void);
 void drawable_class_setup(lua_State *);
 
 #endif
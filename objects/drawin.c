@@ -182,6 +182,11 @@ drawin_wipe(drawin_t *w)
     {
         /* Make sure we don't accidentally kill the systray window */
         drawin_systray_kickout(w);
+        window_index_remove(w->window, (window_t *) w);
+        /* Forget about pending geometry changes */
+        for(int i = globalconf.refresh.drawins.len - 1; i >= 0; i--)
+            if(globalconf.refresh.drawins.tab[i] == w)
+                drawin_array_take(&globalconf.refresh.drawins, i);
         xcb_destroy_window(globalconf.connection, w->window);
         w->window = XCB_NONE;
     }
@@ -198,15 +203,6 @@ drawin_update_drawing(lua_State *L, int widx)
     lua_pop(L, 1);
 }
 
-/** Refresh the window content by copying its pixmap data to its window.
- * \param w The drawin to refresh.
- */
-static inline void
-drawin_refresh_pixmap(drawin_t *w)
-{
-    drawin_refresh_pixmap_partial(w, 0, 0, w->geometry.width, w->geometry.height);
-}
-
 static void
 drawin_apply_moveresize(drawin_t *w)
 {
@@ -231,11 +227,10 @@ drawin_apply_moveresize(drawin_t *w)
 void
 drawin_refresh(void)
 {
-    foreach(item, globalconf.drawins)
-    {
+    foreach(item, globalconf.refresh.drawins)
         drawin_apply_moveresize(*item);
-        window_border_refresh((window_t *) *item);
-    }
+    globalconf.stats.refresh_drawins += globalconf.refresh.drawins.len;
+    globalconf.refresh.drawins.len = 0;
 }
 
 /** Move and/or resize a drawin
@@ -255,19 +250,22 @@ drawin_moveresize(lua_State *L, int udx, area_t geometry)
     if(w->geometry.height <= 0)
         w->geometry.height = old_geometry.height;
 
+    /* Queue the drawin unless it still is queued from an earlier change */
+    if(!w->geometry_dirty)
+        drawin_array_append(&globalconf.refresh.drawins, w);
     w->geometry_dirty = true;
     drawin_update_drawing(L, udx);
 
     if (!AREA_EQUAL(old_geometry, w->geometry))
-        luaA_object_emit_signal(L, udx, "property::geometry", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::geometry"), 0);
     if (old_geometry.x != w->geometry.x)
-        luaA_object_emit_signal(L, udx, "property::x", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::x"), 0);
     if (old_geometry.y != w->geometry.y)
-        luaA_object_emit_signal(L, udx, "property::y", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::y"), 0);
     if (old_geometry.width != w->geometry.width)
-        luaA_object_emit_signal(L, udx, "property::width", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::width"), 0);
     if (old_geometry.height != w->geometry.height)
-        luaA_object_emit_signal(L, udx, "property::height", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::height"), 0);
 
     screen_t *old_screen = screen_getbycoord(old_geometry.x, old_geometry.y);
     screen_t *new_screen = screen_getbycoord(w->geometry.x, w->geometry.y);
@@ -336,17 +334,15 @@ drawin_unmap(drawin_t *drawin)
         }
 }
 
-/** Get a drawin by its window.
+/** Get a visible drawin by its window.
  * \param win The window id.
  * \return A drawin if found, NULL otherwise.
  */
 drawin_t *
 drawin_getbywin(xcb_window_t win)
 {
-    foreach(w, globalconf.drawins)
-        if((*w)->window == win)
-            return *w;
-    return NULL;
+    drawin_t *w = (drawin_t *) window_index_lookup(win, WINDOW_ROLE_DRAWIN);
+    return w && w->visible ? w : NULL;
 }
 
 /** Set a drawin visible or not.
@@ -379,10 +375,10 @@ drawin_set_visible(lua_State *L, int udx, bool v)
             /* Active BMA */
             client_restore_enterleave_events();
             /* unref it */
-            luaA_object_unref(L, drawin);
+            luaA_object_unref_class(L, drawin);
         }
 
-        luaA_object_emit_signal(L, udx, "property::visible", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::visible"), 0);
         if(strut_has_value(&drawin->strut))
         {
             screen_update_workarea(
@@ -406,7 +402,7 @@ drawin_allocator(lua_State *L)
     w->geometry_dirty = false;
     w->type = _NET_WM_WINDOW_TYPE_NORMAL;
 
-    drawable_allocator(L, (drawable_refresh_callback *) drawin_refresh_pixmap, w);
+    drawable_allocator(L, (drawable_refresh_callback *) drawin_refresh_pixmap_partial, w);
     w->drawable = luaA_object_ref_item(L, -2, -1);
 
     w->window = xcb_generate_id(globalconf.connection);
@@ -433,6 +429,7 @@ drawin_allocator(lua_State *L)
                       });
     xwindow_set_class_instance(w->window);
     xwindow_set_name_static(w->window, "Awesome drawin");
+    window_index_add(w->window, WINDOW_ROLE_DRAWIN, (window_t *) w);
 
     /* Set the right properties */
     ewmh_update_window_type(w->window, window_translate_type(w->type));
@@ -572,7 +569,7 @@ luaA_drawin_set_ontop(lua_State *L, drawin_t *drawin)
     {
         drawin->ontop = b;
         stack_windows();
-        luaA_object_emit_signal(L, -3, "property::ontop", 0);
+        luaA_object_emit_signal(L, -3, SIGNAL_ID("property::ontop"), 0);
     }
     return 0;
 }
@@ -595,7 +592,7 @@ luaA_drawin_set_cursor(lua_State *L, drawin_t *drawin)
             p_delete(&drawin->cursor);
             drawin->cursor = a_strdup(buf);
             xwindow_set_cursor(drawin->window, cursor);
-            luaA_object_emit_signal(L, -3, "property::cursor", 0);
+            luaA_object_emit_signal(L, -3, SIGNAL_ID("property::cursor"), 0);
         }
     }
     return 0;
@@ -660,7 +657,7 @@ luaA_drawin_set_shape_bounding(lua_State *L, drawin_t *drawin)
             drawin->geometry.width + 2*drawin->border_width,
             drawin->geometry.height + 2*drawin->border_width,
             XCB_SHAPE_SK_BOUNDING, surf, -drawin->border_width);
-    luaA_object_emit_signal(L, -3, "property::shape_bounding", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_bounding"), 0);
     return 0;
 }
 
@@ -697,7 +694,7 @@ luaA_drawin_set_shape_clip(lua_State *L, drawin_t *drawin)
 
     xwindow_set_shape(drawin->window, drawin->geometry.width, drawin->geometry.height,
             XCB_SHAPE_SK_CLIP, surf, 0);
-    luaA_object_emit_signal(L, -3, "property::shape_clip", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_clip"), 0);
     return 0;
 }
 
@@ -736,7 +733,7 @@ luaA_drawin_set_shape_input(lua_State *L, drawin_t *drawin)
             drawin->geometry.width + 2*drawin->border_width,
             drawin->geometry.height + 2*drawin->border_width,
             XCB_SHAPE_SK_INPUT, surf, -drawin->border_width);
-    luaA_object_emit_signal(L, -3, "property::shape_input", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::shape_input"), 0);
     return 0;
 }
 
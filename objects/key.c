@@ -163,7 +163,7 @@ luaA_keystore(lua_State *L, int ud, const char *str, ssize_t len)
         }
     }
 
-    luaA_object_emit_signal(L, ud, "property::key", 0);
+    luaA_object_emit_signal(L, ud, SIGNAL_ID("property::key"), 0);
 }
 
 /** Create a new key object.
@@ -268,7 +268,7 @@ static int
 luaA_key_set_modifiers(lua_State *L, keyb_t *k)
 {
     k->modifiers = luaA_tomodifiers(L, -1);
-    luaA_object_emit_signal(L, -3, "property::modifiers", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::modifiers"), 0);
     return 0;
 }
 
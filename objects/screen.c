@@ -254,7 +254,7 @@ screen_deduplicate(lua_State *L, screen_array_t *screens)
                 first_screen->geometry.height = MAX(first_screen->geometry.height, second_screen->geometry.height);
 
                 screen_array_take(screens, second);
-                luaA_object_unref(L, second_screen);
+                luaA_object_unref_class(L, second_screen);
 
                 /* Restart the search */
                 screen_deduplicate(L, screens);
@@ -268,7 +268,7 @@ static screen_t *
 screen_add(lua_State *L, screen_array_t *screens)
 {
     screen_t *new_screen = screen_new(L);
-    luaA_object_ref(L, -1);
+    luaA_object_ref_class(L, -1, &screen_class);
     screen_array_append(screens, new_screen);
     return new_screen;
 }
@@ -418,7 +418,7 @@ screen_scan_randr_crtcs(lua_State *L, screen_array_t *screens)
 
                 /* Get rid of the screens that we already created */
                 foreach(screen, *screens)
-                    luaA_object_unref(L, *screen);
+                    luaA_object_unref_class(L, *screen);
                 screen_array_wipe(screens);
                 screen_array_init(screens);
 
@@ -548,7 +548,7 @@ screen_added(lua_State *L, screen_t *screen)
     screen->workarea = screen->geometry;
     screen->valid = true;
     luaA_object_push(L, screen);
-    luaA_object_emit_signal(L, -1, "added", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("added"), 0);
     lua_pop(L, 1);
 }
 
@@ -583,7 +583,7 @@ screen_removed(lua_State *L, int sidx)
 {
     screen_t *screen = luaA_checkudata(L, sidx, &screen_class);
 
-    luaA_object_emit_signal(L, sidx, "removed", 0);
+    luaA_object_emit_signal(L, sidx, SIGNAL_ID("removed"), 0);
 
     if (globalconf.primary_screen == screen)
         globalconf.primary_screen = NULL;
@@ -605,7 +605,7 @@ screen_modified(screen_t *existing_screen, screen_t *other_screen)
         existing_screen->geometry = other_screen->geometry;
         luaA_object_push(L, existing_screen);
         luaA_pusharea(L, old_geometry);
-        luaA_object_emit_signal(L, -2, "property::geometry", 1);
+        luaA_object_emit_signal(L, -2, SIGNAL_ID("property::geometry"), 1);
         lua_pop(L, 1);
         screen_update_workarea(existing_screen);
     }
@@ -627,7 +627,7 @@ screen_modified(screen_t *existing_screen, screen_t *other_screen)
 
     if(outputs_changed) {
         luaA_object_push(L, existing_screen);
-        luaA_object_emit_signal(L, -1, "property::outputs", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("property::outputs"), 0);
         lua_pop(L, 1);
     }
 }
@@ -662,7 +662,7 @@ screen_refresh(void)
             /* Get an extra reference since both new_screens and
              * globalconf.screens reference this screen now */
             luaA_object_push(L, *new_screen);
-            luaA_object_ref(L, -1);
+            luaA_object_ref_class(L, -1, &screen_class);
 
             list_changed = true;
         }
@@ -681,7 +681,7 @@ screen_refresh(void)
             luaA_object_push(L, old_screen);
             screen_removed(L, -1);
             lua_pop(L, 1);
-            luaA_object_unref(L, old_screen);
+            luaA_object_unref_class(L, old_screen);
             old_screen->valid = false;
 
             list_changed = true;
@@ -695,13 +695,13 @@ screen_refresh(void)
                 screen_modified(*existing_screen, *new_screen);
 
     foreach(screen, new_screens)
-        luaA_object_unref(L, *screen);
+        luaA_object_unref_class(L, *screen);
     screen_array_wipe(&new_screens);
 
     screen_update_primary();
 
     if (list_changed)
-        luaA_class_emit_signal(L, &screen_class, "list", 0);
+        luaA_class_emit_signal(L, &screen_class, SIGNAL_ID("list"), 0);
 }
 
 /** Return the squared distance of the given screen to the coordinates.
@@ -852,10 +852,13 @@ void screen_update_workarea(screen_t *screen)
 
     area_t old_workarea = screen->workarea;
     screen->workarea = area;
+    if(!luaA_object_has_listeners(&screen_class, screen, SIGNAL_ID("property::workarea")))
+        return;
+
     lua_State *L = globalconf_get_lua_State();
     luaA_object_push(L, screen);
     luaA_pusharea(L, old_workarea);
-    luaA_object_emit_signal(L, -2, "property::workarea", 1);
+    luaA_object_emit_signal(L, -2, SIGNAL_ID("property::workarea"), 1);
     lua_pop(L, 1);
 }
 
@@ -902,7 +905,7 @@ screen_client_moveto(client_t *c, screen_t *new_screen, bool doresize)
             luaA_object_push(L, old_screen);
         else
             lua_pushnil(L);
-        luaA_object_emit_signal(L, -2, "property::screen", 1);
+        luaA_object_emit_signal(L, -2, SIGNAL_ID("property::screen"), 1);
         lua_pop(L, 1);
         if(had_focus)
             client_focus(c);
@@ -941,7 +944,7 @@ screen_client_moveto(client_t *c, screen_t *new_screen, bool doresize)
             luaA_object_push(L, old_screen);
         else
             lua_pushnil(L);
-        luaA_object_emit_signal(L, -2, "property::screen", 1);
+        luaA_object_emit_signal(L, -2, SIGNAL_ID("property::screen"), 1);
         lua_pop(L, 1);
     }
 
@@ -998,11 +1001,11 @@ screen_update_primary(void)
     if (old)
     {
         luaA_object_push(L, old);
-        luaA_object_emit_signal(L, -1, "primary_changed", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("primary_changed"), 0);
         lua_pop(L, 1);
     }
     luaA_object_push(L, primary_screen);
-    luaA_object_emit_signal(L, -1, "primary_changed", 0);
+    luaA_object_emit_signal(L, -1, SIGNAL_ID("primary_changed"), 0);
     lua_pop(L, 1);
 }
 
@@ -1015,7 +1018,7 @@ screen_get_primary(void)
 
         lua_State *L = globalconf_get_lua_State();
         luaA_object_push(L, globalconf.primary_screen);
-        luaA_object_emit_signal(L, -1, "primary_changed", 0);
+        luaA_object_emit_signal(L, -1, SIGNAL_ID("primary_changed"), 0);
         lua_pop(L, 1);
     }
     return globalconf.primary_screen;
@@ -1152,7 +1155,7 @@ luaA_screen_fake_add(lua_State *L)
     s->geometry.height = height;
 
     screen_added(L, s);
-    luaA_class_emit_signal(L, &screen_class, "list", 0);
+    luaA_class_emit_signal(L, &screen_class, SIGNAL_ID("list"), 0);
     luaA_object_push(L, s);
 
     return 1;
@@ -1174,8 +1177,8 @@ luaA_screen_fake_remove(lua_State *L)
     luaA_object_push(L, s);
     screen_removed(L, -1);
     lua_pop(L, 1);
-    luaA_class_emit_signal(L, &screen_class, "list", 0);
-    luaA_object_unref(L, s);
+    luaA_class_emit_signal(L, &screen_class, SIGNAL_ID("list"), 0);
+    luaA_object_unref_class(L, s);
     s->valid = false;
 
     return 0;
@@ -1206,7 +1209,7 @@ luaA_screen_fake_resize(lua_State *L)
     screen_update_workarea(screen);
 
     luaA_pusharea(L, old_geometry);
-    luaA_object_emit_signal(L, 1, "property::geometry", 1);
+    luaA_object_emit_signal(L, 1, SIGNAL_ID("property::geometry"), 1);
 
     return 0;
 }
@@ -1237,16 +1240,16 @@ luaA_screen_swap(lua_State *L)
         *ref_s = swap;
         *ref_swap = s;
 
-        luaA_class_emit_signal(L, &screen_class, "list", 0);
+        luaA_class_emit_signal(L, &screen_class, SIGNAL_ID("list"), 0);
 
         luaA_object_push(L, swap);
         lua_pushboolean(L, true);
-        luaA_object_emit_signal(L, -4, "swapped", 2);
+        luaA_object_emit_signal(L, -4, SIGNAL_ID("swapped"), 2);
 
         luaA_object_push(L, swap);
         luaA_object_push(L, s);
         lua_pushboolean(L, false);
-        luaA_object_emit_signal(L, -3, "swapped", 2);
+        luaA_object_emit_signal(L, -3, SIGNAL_ID("swapped"), 2);
     }
 
     return 0;
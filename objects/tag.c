@@ -256,16 +256,39 @@ void
 tag_unref_simplified(tag_t **tag)
 {
     lua_State *L = globalconf_get_lua_State();
-    luaA_object_unref(L, *tag);
+    luaA_object_unref_class(L, *tag);
+}
+
+static tag_t *
+tag_allocator(lua_State *L)
+{
+    tag_t *tag = tag_new(L);
+    tag->bit = bitset_add_first_unset(&globalconf.tag_bits);
+    return tag;
 }
 
 static void
 tag_wipe(tag_t *tag)
 {
+    bitset_clear(&globalconf.selected_tags, tag->bit);
+    bitset_clear(&globalconf.tag_bits, tag->bit);
     client_array_wipe(&tag->clients);
     p_delete(&tag->name);
 }
 
+/** Update the bit of a tag in the set of selected tags, which only contains
+ * tags that are both activated and selected.
+ * \param tag The tag.
+ */
+static void
+tag_update_selected_tags(tag_t *tag)
+{
+    if(tag->activated && tag->selected)
+        bitset_set(&globalconf.selected_tags, tag->bit);
+    else
+        bitset_clear(&globalconf.selected_tags, tag->bit);
+}
+
 OBJECT_EXPORT_PROPERTY(tag, tag_t, selected)
 OBJECT_EXPORT_PROPERTY(tag, tag_t, name)
 
@@ -281,16 +304,17 @@ tag_view(lua_State *L, int udx, bool view)
     if(tag->selected != view)
     {
         tag->selected = view;
-        banning_need_update();
+        tag_update_selected_tags(tag);
+        banning_tag_need_update(tag);
         foreach(screen, globalconf.screens)
             screen_update_workarea(*screen);
 
-        luaA_object_emit_signal(L, udx, "property::selected", 0);
+        luaA_object_emit_signal(L, udx, SIGNAL_ID("property::selected"), 0);
     }
 }
 
 static void
-tag_client_emit_signal(tag_t *t, client_t *c, const char *signame)
+tag_client_emit_signal(tag_t *t, client_t *c, signal_id_t signame)
 {
     lua_State *L = globalconf_get_lua_State();
     luaA_object_push(L, c);
@@ -318,16 +342,17 @@ tag_client(lua_State *L, client_t *c)
     /* don't tag twice */
     if(is_client_tagged(c, t))
     {
-        luaA_object_unref(L, t);
+        luaA_object_unref_class(L, t);
         return;
     }
 
     client_array_append(&t->clients, c);
+    bitset_set(&c->tags, t->bit);
     ewmh_client_update_desktop(c);
-    banning_need_update();
+    banning_client_need_update(c);
     screen_update_workarea(c->screen);
 
-    tag_client_emit_signal(t, c, "tagged");
+    tag_client_emit_signal(t, c, SIGNAL_ID("tagged"));
 }
 
 /** Untag a client with specified tag.
@@ -337,16 +362,20 @@ tag_client(lua_State *L, client_t *c)
 void
 untag_client(client_t *c, tag_t *t)
 {
+    if(!is_client_tagged(c, t))
+        return;
+
     for(int i = 0; i < t->clients.len; i++)
         if(t->clients.tab[i] == c)
         {
             lua_State *L = globalconf_get_lua_State();
             client_array_take(&t->clients, i);
-            banning_need_update();
+            bitset_clear(&c->tags, t->bit);
+            banning_client_need_update(c);
             ewmh_client_update_desktop(c);
             screen_update_workarea(c->screen);
-            tag_client_emit_signal(t, c, "untagged");
-            luaA_object_unref(L, t);
+            tag_client_emit_signal(t, c, SIGNAL_ID("untagged"));
+            luaA_object_unref_class(L, t);
             return;
         }
 }
@@ -359,11 +388,7 @@ untag_client(client_t *c, tag_t *t)
 bool
 is_client_tagged(client_t *c, tag_t *t)
 {
-    for(int i = 0; i < t->clients.len; i++)
-        if(t->clients.tab[i] == c)
-            return true;
-
-    return false;
+    return bitset_test(&c->tags, t->bit);
 }
 
 /** Get the index of the tag with focused client or first selected 
@@ -479,7 +504,7 @@ luaA_tag_set_name(lua_State *L, tag_t *tag)
     const char *buf = luaL_checklstring(L, -1, &len);
     p_delete(&tag->name);
     a_iso2utf8(buf, len, &tag->name, NULL);
-    luaA_object_emit_signal(L, -3, "property::name", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::name"), 0);
     ewmh_update_net_desktop_names();
     return 0;
 }
@@ -509,8 +534,11 @@ luaA_tag_set_activated(lua_State *L, tag_t *tag)
         return 0;
 
     tag->activated = activated;
+    tag_update_selected_tags(tag);
     if(activated)
     {
+        if(tag->selected)
+            banning_tag_need_update(tag);
         lua_pushvalue(L, -3);
         tag_array_append(&globalconf.tags, luaA_object_ref_class(L, -1, &tag_class));
     }
@@ -526,15 +554,16 @@ luaA_tag_set_activated(lua_State *L, tag_t *tag)
         if (tag->selected)
         {
             tag->selected = false;
-            luaA_object_emit_signal(L, -3, "property::selected", 0);
-            banning_need_update();
+            tag_update_selected_tags(tag);
+            luaA_object_emit_signal(L, -3, SIGNAL_ID("property::selected"), 0);
+            banning_tag_need_update(tag);
         }
-        luaA_object_unref(L, tag);
+        luaA_object_unref_class(L, tag);
     }
     ewmh_update_net_numbers_of_desktop();
     ewmh_update_net_desktop_names();
 
-    luaA_object_emit_signal(L, -3, "property::activated", 0);
+    luaA_object_emit_signal(L, -3, SIGNAL_ID("property::activated"), 0);
 
     return 0;
 }
@@ -558,7 +587,7 @@ tag_class_setup(lua_State *L)
     };
 
     luaA_class_setup(L, &tag_class, "tag", NULL,
-                     (lua_class_allocator_t) tag_new,
+                     (lua_class_allocator_t) tag_allocator,
                      (lua_class_collector_t) tag_wipe,
                      NULL,
                      luaA_class_index_miss_property, luaA_class_newindex_miss_property,
@@ -44,6 +44,8 @@ struct tag
     bool selected;
     /** clients in this tag */
     client_array_t clients;
+    /** Index of this tag in client_t.tags and globalconf.selected_tags */
+    int bit;
 };
 
 lua_class_t tag_class;
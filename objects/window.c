@@ -69,9 +69,96 @@ window_get(window_t *window)
     return window->window;
 }
 
+/** An entry of the window index */
+typedef struct
+{
+    /** What the window is used for */
+    window_role_t role;
+    /** The object owning the window */
+    window_t *object;
+} window_index_entry_t;
+
+/** Initialize the index which maps X window ids to our objects.
+ */
+void
+window_index_init(void)
+{
+    globalconf.window_index = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                                    NULL, free);
+}
+
+/** Remember which object owns a window.
+ * \param win The X window id.
+ * \param role What the window is used for.
+ * \param object The client or drawin owning the window.
+ */
+void
+window_index_add(xcb_window_t win, window_role_t role, window_t *object)
+{
+    window_index_entry_t *entry;
+
+    if(win == XCB_NONE)
+        return;
+
+    entry = p_new(window_index_entry_t, 1);
+    entry->role = role;
+    entry->object = object;
+    g_hash_table_replace(globalconf.window_index, GUINT_TO_POINTER(win), entry);
+}
+
+/** Forget about a window.
+ * \param win The X window id.
+ * \param object The object that owned the window. The entry is only removed
+ * when it still belongs to this object.
+ */
+void
+window_index_remove(xcb_window_t win, window_t *object)
+{
+    window_index_entry_t *entry;
+
+    if(win == XCB_NONE)
+        return;
+
+    entry = g_hash_table_lookup(globalconf.window_index, GUINT_TO_POINTER(win));
+    if(entry && entry->object == object)
+        g_hash_table_remove(globalconf.window_index, GUINT_TO_POINTER(win));
+}
+
+/** Get the object owning a window.
+ * \param win The X window id.
+ * \param role Where to store the role of the window, may be NULL.
+ * \return The object owning the window, or NULL if unknown.
+ */
+window_t *
+window_index_get(xcb_window_t win, window_role_t *role)
+{
+    window_index_entry_t *entry = NULL;
+
+    if(win != XCB_NONE)
+        entry = g_hash_table_lookup(globalconf.window_index, GUINT_TO_POINTER(win));
+
+    if(role)
+        *role = entry ? entry->role : WINDOW_ROLE_NONE;
+    return entry ? entry->object : NULL;
+}
+
+/** Get the object owning a window if the window has the given role.
+ * \param win The X window id.
+ * \param role The role that the window must have.
+ * \return The object owning the window, or NULL.
+ */
+window_t *
+window_index_lookup(xcb_window_t win, window_role_t role)
+{
+    window_role_t found;
+    window_t *object = window_index_get(win, &found);
+    return found == role ? object : NULL;
+}
+
 static void
 window_wipe(window_t *window)
 {
+    window_border_forget(window);
     button_array_wipe(&window->buttons);
 }
 
@@ -87,7 +174,7 @@ luaA_window_buttons(lua_State *L)
     if(lua_gettop(L) == 2)
     {
         luaA_button_array_set(L, 1, 2, &window->buttons);
-        luaA_object_emit_signal(L, 1, "property::buttons", 0);
+        luaA_object_emit_signal(L, 1, SIGNAL_ID("property::buttons"), 0);
         xwindow_buttons_grab(window_get(window), &window->buttons);
         xwindow_buttons_grab(window->window, &window->buttons);
     }
@@ -108,7 +195,7 @@ luaA_window_struts(lua_State *L)
     {
         luaA_tostrut(L, 2, &window->strut);
         ewmh_update_strut(window->window, &window->strut);
-        luaA_object_emit_signal(L, 1, "property::struts", 0);
+        luaA_object_emit_signal(L, 1, SIGNAL_ID("property::struts"), 0);
         /* We don't know the correct screen, update them all */
         foreach(s, globalconf.screens)
             screen_update_workarea(*s);
@@ -131,7 +218,7 @@ window_set_opacity(lua_State *L, int idx, double opacity)
     {
         window->opacity = opacity;
         xwindow_set_opacity(window_get(window), opacity);
-        luaA_object_emit_signal(L, idx, "property::opacity", 0);
+        luaA_object_emit_signal(L, idx, SIGNAL_ID("property::opacity"), 0);
     }
 }
 
@@ -170,7 +257,7 @@ luaA_window_get_opacity(lua_State *L, window_t *window)
     return 1;
 }
 
-void
+static void
 window_border_refresh(window_t *window)
 {
     if(!window->border_need_update)
@@ -183,6 +270,46 @@ window_border_refresh(window_t *window)
                              (uint32_t[]) { window->border_width });
 }
 
+/** Queue a window for getting its border updated in the next refresh.
+ * \param window The window object.
+ */
+static void
+window_border_need_update(window_t *window)
+{
+    if(window->border_need_update)
+        return;
+    window->border_need_update = true;
+    window_object_array_append(&globalconf.refresh.borders, window);
+}
+
+/** Drop a pending border update, e.g. because the window goes away.
+ * \param window The window object.
+ */
+void
+window_border_forget(window_t *window)
+{
+    if(!window->border_need_update)
+        return;
+    window->border_need_update = false;
+    foreach(item, globalconf.refresh.borders)
+        if(*item == window)
+        {
+            window_object_array_remove(&globalconf.refresh.borders, item);
+            break;
+        }
+}
+
+/** Apply all pending border changes.
+ */
+void
+window_refresh(void)
+{
+    foreach(item, globalconf.refresh.borders)
+        window_border_refresh(*item);
+    globalconf.stats.refresh_borders += globalconf.refresh.borders.len;
+    globalconf.refresh.borders.len = 0;
+}
+
 /** Set the window border color.
  * \param L The Lua VM state.
  * \param window The window object.
@@ -197,8 +324,8 @@ luaA_window_set_border_color(lua_State *L, window_t *window)
     if(color_name &&
        color_init_reply(color_init_unchecked(&window->border_color, color_name, len)))
     {
-        window->border_need_update = true;
-        luaA_object_emit_signal(L, -3, "property::border_color", 0);
+        window_border_need_update(window);
+        luaA_object_emit_signal(L, -3, SIGNAL_ID("property::border_color"), 0);
     }
 
     return 0;
@@ -218,13 +345,13 @@ window_set_border_width(lua_State *L, int idx, int width)
     if(width == window->border_width || width < 0)
         return;
 
-    window->border_need_update = true;
+    window_border_need_update(window);
     window->border_width = width;
 
     if(window->border_width_callback)
         (*window->border_width_callback)(window, old_width, width);
 
-    luaA_object_emit_signal(L, idx, "property::border_width", 0);
+    luaA_object_emit_signal(L, idx, SIGNAL_ID("property::border_width"), 0);
 }
 
 /** Get the window type.
@@ -335,7 +462,7 @@ luaA_window_set_type(lua_State *L, window_t *w)
         w->type = type;
         if(w->window != XCB_WINDOW_NONE)
             ewmh_update_window_type(w->window, window_translate_type(w->type));
-        luaA_object_emit_signal(L, -3, "property::type", 0);
+        luaA_object_emit_signal(L, -3, SIGNAL_ID("property::type"), 0);
     }
 
     return 0;
@@ -51,6 +51,20 @@ typedef enum
     WINDOW_TYPE_DND
 } window_type_t;
 
+/** What one of our X windows is used for, see window_index_add() */
+typedef enum
+{
+    WINDOW_ROLE_NONE = 0,
+    /** The window of a managed client */
+    WINDOW_ROLE_CLIENT,
+    /** The frame window of a client; titlebars are drawn into it */
+    WINDOW_ROLE_FRAME,
+    /** The window used to focus a client which does not want input */
+    WINDOW_ROLE_NOFOCUS,
+    /** The window of a drawin */
+    WINDOW_ROLE_DRAWIN
+} window_role_t;
+
 #define WINDOW_OBJECT_HEADER \
     LUA_OBJECT_HEADER \
     /** The X window number */ \
@@ -75,10 +89,12 @@ typedef enum
     void (*border_width_callback)(void *, uint16_t old, uint16_t new);
 
 /** Window structure */
-typedef struct
+struct window_t
 {
     WINDOW_OBJECT_HEADER
-} window_t;
+};
+
+ARRAY_FUNCS(window_t *, window_object, DO_NOTHING)
 
 lua_class_t window_class;
 
@@ -86,12 +102,19 @@ void window_class_setup(lua_State *);
 
 void window_set_opacity(lua_State *, int, double);
 void window_set_border_width(lua_State *, int, int);
-void window_border_refresh(window_t *);
+void window_border_forget(window_t *);
+void window_refresh(void);
 int luaA_window_get_type(lua_State *, window_t *);
 int luaA_window_set_type(lua_State *, window_t *);
 uint32_t window_translate_type(window_type_t);
 int window_set_xproperty(lua_State *, xcb_window_t, int, int);
 int window_get_xproperty(lua_State *, xcb_window_t, int);
 
+void window_index_init(void);
+void window_index_add(xcb_window_t, window_role_t, window_t *);
+void window_index_remove(xcb_window_t, window_t *);
+window_t *window_index_get(xcb_window_t, window_role_t *);
+window_t *window_index_lookup(xcb_window_t, window_role_t);
+
 #endif
 // vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
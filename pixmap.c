@@ -0,0 +1,154 @@
+/*
+ * pixmap.c - pool of recycled pixmaps
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Drawables get a new pixmap every time their size changes. Instead of
+ * creating and freeing server-side pixmaps for every frame of an animation or
+ * an interactive resize, pixmaps are created with a rounded-up size and put
+ * back into this pool when they are no longer needed. Unused pixmaps are freed
+ * in least recently used order when the pool grows beyond its limit.
+ */
+
+#include "pixmap.h"
+#include "globalconf.h"
+
+/** The default memory limit of the unused pixmaps in the pool */
+#define PIXMAP_POOL_DEFAULT_LIMIT (16 * 1024 * 1024)
+
+typedef struct
+{
+    xcb_pixmap_t pixmap;
+    uint8_t depth;
+    /** The real size of the pixmap, which is a size class */
+    uint16_t width, height;
+} pooled_pixmap_t;
+
+static void
+pooled_pixmap_wipe(pooled_pixmap_t *p)
+{
+    xcb_free_pixmap(globalconf.connection, p->pixmap);
+}
+
+DO_ARRAY(pooled_pixmap_t, pooled_pixmap, pooled_pixmap_wipe)
+
+/** Unused pixmaps, the least recently used one first */
+static pooled_pixmap_array_t pool;
+static size_t pool_limit = PIXMAP_POOL_DEFAULT_LIMIT;
+
+/** Round a size up to its size class. Size classes are eight steps between
+ * successive powers of two, so at most an eighth of each dimension is wasted.
+ * \param size The size.
+ * \return The size class.
+ */
+static uint16_t
+pixmap_size_class(uint16_t size)
+{
+    unsigned int step = 1;
+
+    while(step * 16 <= size)
+        step *= 2;
+
+    return MIN((size + step - 1) / step * step, UINT16_MAX);
+}
+
+static size_t
+pixmap_bytes(uint8_t depth, uint16_t width, uint16_t height)
+{
+    size_t bpp = depth > 16 ? 4 : depth > 8 ? 2 : 1;
+    return bpp * width * height;
+}
+
+/** Free unused pixmaps until the pool fits into its limit. */
+static void
+pixmap_pool_trim(void)
+{
+    while(pool.len > 0 && globalconf.stats.pixmap_pool_bytes > pool_limit)
+    {
+        pooled_pixmap_t p = pooled_pixmap_array_take(&pool, 0);
+        globalconf.stats.pixmap_pool_bytes -= pixmap_bytes(p.depth, p.width, p.height);
+        globalconf.stats.pixmap_evictions++;
+        pooled_pixmap_wipe(&p);
+    }
+}
+
+/** Get a pixmap that is at least as big as the requested size.
+ * \param depth The depth of the pixmap.
+ * \param width The minimum width of the pixmap.
+ * \param height The minimum height of the pixmap.
+ * \return A pixmap with unspecified content. It should be given back with
+ * pixmap_pool_put() with the same arguments.
+ */
+xcb_pixmap_t
+pixmap_pool_get(uint8_t depth, uint16_t width, uint16_t height)
+{
+    uint16_t class_width = pixmap_size_class(width);
+    uint16_t class_height = pixmap_size_class(height);
+    xcb_pixmap_t pixmap;
+
+    /* Prefer the most recently used pixmaps */
+    for(int i = pool.len - 1; i >= 0; i--)
+    {
+        pooled_pixmap_t *p = &pool.tab[i];
+        if(p->depth == depth && p->width == class_width && p->height == class_height)
+        {
+            pixmap = pooled_pixmap_array_take(&pool, i).pixmap;
+            globalconf.stats.pixmap_pool_bytes -= pixmap_bytes(depth, class_width, class_height);
+            globalconf.stats.pixmap_hits++;
+            return pixmap;
+        }
+    }
+
+    pixmap = xcb_generate_id(globalconf.connection);
+    xcb_create_pixmap(globalconf.connection, depth, pixmap,
+                      globalconf.screen->root, class_width, class_height);
+    globalconf.stats.pixmap_misses++;
+    return pixmap;
+}
+
+/** Give a pixmap back to the pool.
+ * \param pixmap A pixmap from pixmap_pool_get().
+ * \param depth The depth it was requested with.
+ * \param width The width it was requested with.
+ * \param height The height it was requested with.
+ */
+void
+pixmap_pool_put(xcb_pixmap_t pixmap, uint8_t depth, uint16_t width, uint16_t height)
+{
+    pooled_pixmap_t p = {
+        .pixmap = pixmap,
+        .depth = depth,
+        .width = pixmap_size_class(width),
+        .height = pixmap_size_class(height)
+    };
+
+    pooled_pixmap_array_append(&pool, p);
+    globalconf.stats.pixmap_pool_bytes += pixmap_bytes(depth, p.width, p.height);
+    pixmap_pool_trim();
+}
+
+/** Set the maximum memory used by unused pixmaps.
+ * \param limit The limit in bytes, 0 disables the pool.
+ */
+void
+pixmap_pool_set_limit(size_t limit)
+{
+    pool_limit = limit;
+    pixmap_pool_trim();
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
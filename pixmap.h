@@ -0,0 +1,32 @@
+/*
+ * pixmap.h - pool of recycled pixmaps header
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AWESOME_PIXMAP_H
+#define AWESOME_PIXMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+xcb_pixmap_t pixmap_pool_get(uint8_t, uint16_t, uint16_t);
+void pixmap_pool_put(xcb_pixmap_t, uint8_t, uint16_t, uint16_t);
+void pixmap_pool_set_limit(size_t);
+
+#endif
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
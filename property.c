@@ -31,11 +31,11 @@
 
 #define HANDLE_TEXT_PROPERTY(funcname, atom, setfunc) \
     xcb_get_property_cookie_t \
-    property_get_##funcname(client_t *c) \
+    property_get_##funcname(xcb_window_t window) \
     { \
         return xcb_get_property(globalconf.connection, \
                                 false, \
-                                c->window, \
+                                window, \
                                 atom, \
                                 XCB_GET_PROPERTY_TYPE_ANY, \
                                 0, \
@@ -58,7 +58,7 @@
     { \
         client_t *c = client_getbywin(window); \
         if(c) \
-            property_update_##funcname(c, property_get_##funcname(c));\
+            property_update_##funcname(c, property_get_##funcname(c->window));\
         return 0; \
     }
 
@@ -79,7 +79,7 @@ HANDLE_TEXT_PROPERTY(wm_window_role, WM_WINDOW_ROLE, client_set_role)
     { \
         client_t *c = client_getbywin(window); \
         if(c) \
-            property_update_##name(c, property_get_##name(c));\
+            property_update_##name(c, property_get_##name(c->window));\
         return 0; \
     }
 
@@ -95,9 +95,9 @@ HANDLE_PROPERTY(net_wm_pid)
 #undef HANDLE_PROPERTY
 
 xcb_get_property_cookie_t
-property_get_wm_transient_for(client_t *c)
+property_get_wm_transient_for(xcb_window_t window)
 {
-    return xcb_icccm_get_wm_transient_for_unchecked(globalconf.connection, c->window);
+    return xcb_icccm_get_wm_transient_for_unchecked(globalconf.connection, window);
 }
 
 void
@@ -123,9 +123,9 @@ property_update_wm_transient_for(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_wm_client_leader(client_t *c)
+property_get_wm_client_leader(xcb_window_t window)
 {
-    return xcb_get_property_unchecked(globalconf.connection, false, c->window,
+    return xcb_get_property_unchecked(globalconf.connection, false, window,
                                       WM_CLIENT_LEADER, XCB_ATOM_WINDOW, 0, 32);
 }
 
@@ -148,9 +148,9 @@ property_update_wm_client_leader(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_wm_normal_hints(client_t *c)
+property_get_wm_normal_hints(xcb_window_t window)
 {
-    return xcb_icccm_get_wm_normal_hints_unchecked(globalconf.connection, c->window);
+    return xcb_icccm_get_wm_normal_hints_unchecked(globalconf.connection, window);
 }
 
 /** Update the size hints of a client.
@@ -166,9 +166,9 @@ property_update_wm_normal_hints(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_wm_hints(client_t *c)
+property_get_wm_hints(xcb_window_t window)
 {
-    return xcb_icccm_get_wm_hints_unchecked(globalconf.connection, c->window);
+    return xcb_icccm_get_wm_hints_unchecked(globalconf.connection, window);
 }
 
 /** Update the WM hints of a client.
@@ -189,7 +189,7 @@ property_update_wm_hints(client_t *c, xcb_get_property_cookie_t cookie)
     luaA_object_push(L, c);
 
     lua_pushboolean(L, xcb_icccm_wm_hints_get_urgency(&wmh));
-    luaA_object_emit_signal(L, -2, "request::urgent", 1);
+    luaA_object_emit_signal(L, -2, SIGNAL_ID("request::urgent"), 1);
 
     if(wmh.flags & XCB_ICCCM_WM_HINT_INPUT)
         c->nofocus = !wmh.input;
@@ -212,9 +212,9 @@ property_update_wm_hints(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_wm_class(client_t *c)
+property_get_wm_class(xcb_window_t window)
 {
-    return xcb_icccm_get_wm_class_unchecked(globalconf.connection, c->window);
+    return xcb_icccm_get_wm_class_unchecked(globalconf.connection, window);
 }
 
 /** Update WM_CLASS of a client.
@@ -252,18 +252,18 @@ property_handle_net_wm_strut_partial(uint8_t state,
 }
 
 xcb_get_property_cookie_t
-property_get_net_wm_icon(client_t *c)
+property_get_net_wm_icon(xcb_window_t window)
 {
-    return ewmh_window_icon_get_unchecked(c->window);
+    return ewmh_window_icon_get_unchecked(window);
 }
 
 void
 property_update_net_wm_icon(client_t *c, xcb_get_property_cookie_t cookie)
 {
-    cairo_surface_array_t array = ewmh_window_icon_get_reply(cookie);
+    icon_array_t array = ewmh_window_icon_get_reply(cookie);
     if (array.len == 0)
     {
-        cairo_surface_array_wipe(&array);
+        icon_array_wipe(&array);
         return;
     }
     c->have_ewmh_icon = true;
@@ -271,9 +271,9 @@ property_update_net_wm_icon(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_net_wm_pid(client_t *c)
+property_get_net_wm_pid(xcb_window_t window)
 {
-    return xcb_get_property_unchecked(globalconf.connection, false, c->window, _NET_WM_PID, XCB_ATOM_CARDINAL, 0L, 1L);
+    return xcb_get_property_unchecked(globalconf.connection, false, window, _NET_WM_PID, XCB_ATOM_CARDINAL, 0L, 1L);
 }
 
 void
@@ -299,10 +299,10 @@ property_update_net_wm_pid(client_t *c, xcb_get_property_cookie_t cookie)
 }
 
 xcb_get_property_cookie_t
-property_get_wm_protocols(client_t *c)
+property_get_wm_protocols(xcb_window_t window)
 {
     return xcb_icccm_get_wm_protocols_unchecked(globalconf.connection,
-						c->window, WM_PROTOCOLS);
+						window, WM_PROTOCOLS);
 }
 
 /** Update the list of supported protocols for a client.
@@ -381,7 +381,7 @@ property_handle_xrootpmap_id(uint8_t state,
 {
     lua_State *L = globalconf_get_lua_State();
     root_update_wallpaper();
-    signal_object_emit(L, &global_signals, "wallpaper_changed", 0);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("wallpaper_changed"), 0);
     return 0;
 }
 
@@ -394,7 +394,6 @@ property_handle_propertynotify_xproperty(xcb_property_notify_event_t *ev)
     lua_State *L = globalconf_get_lua_State();
     xproperty_t *prop;
     xproperty_t lookup = { .atom = ev->atom };
-    buffer_t buf;
     void *obj;
 
     prop = xproperty_array_lookup(&globalconf.xproperties, &lookup);
@@ -404,27 +403,24 @@ property_handle_propertynotify_xproperty(xcb_property_notify_event_t *ev)
 
     if (ev->window != globalconf.screen->root)
     {
-        obj = client_getbywin(ev->window);
-        if(!obj)
-            obj = drawin_getbywin(ev->window);
-        if(!obj)
+        window_role_t role;
+        /* One lookup for both clients and (visible) drawins */
+        obj = window_index_get(ev->window, &role);
+        if(role != WINDOW_ROLE_CLIENT && role != WINDOW_ROLE_DRAWIN)
+            return;
+        if(role == WINDOW_ROLE_DRAWIN && !((drawin_t *) obj)->visible)
             return;
     } else
         obj = NULL;
 
-    /* Get us the name of the property */
-    buffer_inita(&buf, a_strlen(prop->name) + a_strlen("xproperty::") + 1);
-    buffer_addf(&buf, "xproperty::%s", prop->name);
-
     /* And emit the right signal */
     if (obj)
     {
         luaA_object_push(L, obj);
-        luaA_object_emit_signal(L, -1, buf.s, 0);
+        luaA_object_emit_signal(L, -1, prop->signal, 0);
         lua_pop(L, 1);
     } else
-        signal_object_emit(L, &global_signals, buf.s, 0);
-    buffer_wipe(&buf);
+        signal_object_emit(L, &global_signals, prop->signal, 0);
 }
 
 /** The property notify event handler.
@@ -528,6 +524,13 @@ luaA_register_xproperty(lua_State *L)
     }
     else
     {
+        buffer_t buf;
+
+        buffer_inita(&buf, a_strlen(name) + a_strlen("xproperty::") + 1);
+        buffer_addf(&buf, "xproperty::%s", name);
+        property.signal = signal_intern(buf.s);
+        buffer_wipe(&buf);
+
         property.name = a_strdup(name);
         xproperty_array_insert(&globalconf.xproperties, property);
     }
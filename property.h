@@ -25,7 +25,7 @@
 #include "objects/client.h"
 
 #define PROPERTY(funcname) \
-    xcb_get_property_cookie_t property_get_##funcname(client_t *c); \
+    xcb_get_property_cookie_t property_get_##funcname(xcb_window_t window); \
     void property_update_##funcname(client_t *c, xcb_get_property_cookie_t cookie)
 
 PROPERTY(wm_name);
@@ -53,6 +53,8 @@ int luaA_get_xproperty(lua_State *L);
 struct xproperty {
     xcb_atom_t atom;
     const char *name;
+    /** The "xproperty::name" signal */
+    signal_id_t signal;
     enum {
         /* UTF8_STRING */
         PROP_STRING,
@@ -39,6 +39,64 @@
 #include <xcb/xcb_aux.h>
 #include <cairo-xcb.h>
 
+/** The wallpaper that awesome set, kept to update it in place */
+static struct
+{
+    /** Helper connection that owns the wallpaper pixmap, so that the wallpaper
+     * survives a restart of awesome.
+     */
+    xcb_connection_t *connection;
+    /** The wallpaper pixmap, or XCB_NONE if the current wallpaper is not ours */
+    xcb_pixmap_t pixmap;
+    /** The size of the pixmap */
+    uint16_t width, height;
+} root_wallpaper;
+
+/** Make sure that the wallpaper helper connection is usable.
+ * \return True on success.
+ */
+static bool
+root_wallpaper_connect(void)
+{
+    if(root_wallpaper.connection)
+    {
+        if(!xcb_connection_has_error(root_wallpaper.connection))
+            return true;
+        xcb_disconnect(root_wallpaper.connection);
+        root_wallpaper.pixmap = XCB_NONE;
+    }
+
+    root_wallpaper.connection = xcb_connect(NULL, NULL);
+    if(xcb_connection_has_error(root_wallpaper.connection))
+    {
+        xcb_disconnect(root_wallpaper.connection);
+        root_wallpaper.connection = NULL;
+        return false;
+    }
+
+    /* Make sure our pixmaps are not destroyed when we disconnect. */
+    xcb_set_close_down_mode(root_wallpaper.connection, XCB_CLOSE_DOWN_RETAIN_PERMANENT);
+    return true;
+}
+
+/** Forget about our wallpaper after somebody else set a different one. */
+static void
+root_wallpaper_forget(void)
+{
+    if(root_wallpaper.connection)
+    {
+        /* The other program may already have killed our connection through
+         * ESETROOT_PMAP_ID. If it did not, free the pixmap ourselves.
+         */
+        if(root_wallpaper.pixmap != XCB_NONE)
+            xcb_free_pixmap(root_wallpaper.connection, root_wallpaper.pixmap);
+        xcb_flush(root_wallpaper.connection);
+        xcb_disconnect(root_wallpaper.connection);
+        root_wallpaper.connection = NULL;
+    }
+    root_wallpaper.pixmap = XCB_NONE;
+}
+
 static void
 root_set_wallpaper_pixmap(xcb_connection_t *c, xcb_pixmap_t p)
 {
@@ -67,78 +125,167 @@ root_set_wallpaper_pixmap(xcb_connection_t *c, xcb_pixmap_t p)
     if (prop_r && prop_r->value_len)
     {
         xcb_pixmap_t *rootpix = xcb_get_property_value(prop_r);
-        if (rootpix)
+        /* Killing the owner of our own pixmap would kill the helper connection */
+        if (rootpix && *rootpix == root_wallpaper.pixmap)
+            xcb_free_pixmap(c, *rootpix);
+        else if (rootpix)
             xcb_kill_client(c, *rootpix);
     }
     p_delete(&prop_r);
 }
 
+/** Create a new wallpaper pixmap on the helper connection.
+ * \param width The width of the pixmap.
+ * \param height The height of the pixmap.
+ * \return The new pixmap, or XCB_NONE on error.
+ */
+static xcb_pixmap_t
+root_wallpaper_create_pixmap(uint16_t width, uint16_t height)
+{
+    xcb_connection_t *c;
+    xcb_pixmap_t p;
+
+    if(!root_wallpaper_connect())
+        return XCB_NONE;
+
+    c = root_wallpaper.connection;
+    p = xcb_generate_id(c);
+
+    /* Create a pixmap and make sure it is already created, because we are going
+     * to use it from the other X11 connection (Juggling with X11 connections
+     * is a really, really bad idea).
+     */
+    xcb_create_pixmap(c, globalconf.screen->root_depth, p, globalconf.screen->root, width, height);
+    xcb_aux_sync(c);
+
+    if(xcb_connection_has_error(c))
+        return XCB_NONE;
+    return p;
+}
+
+/** Set the wallpaper.
+ * If the current wallpaper was set by us and still has the right size, only
+ * the damaged parts are repainted in place. Otherwise, a new pixmap is created.
+ * \param pattern The pattern to paint.
+ * \param region The area to repaint, or NULL for everything.
+ * \return True on success.
+ */
 static bool
-root_set_wallpaper(cairo_pattern_t *pattern)
+root_set_wallpaper(cairo_pattern_t *pattern, const cairo_region_t *region)
 {
     lua_State *L = globalconf_get_lua_State();
-    xcb_connection_t *c = xcb_connect(NULL, NULL);
-    xcb_pixmap_t p = xcb_generate_id(c);
     /* globalconf.connection should be connected to the same X11 server, so we
      * can just use the info from that other connection.
      */
     const xcb_screen_t *screen = globalconf.screen;
     uint16_t width = screen->width_in_pixels;
     uint16_t height = screen->height_in_pixels;
-    bool result = false;
+    cairo_rectangle_int_t root_rect = { 0, 0, width, height };
+    bool full = root_wallpaper.pixmap == XCB_NONE
+        || root_wallpaper.width != width
+        || root_wallpaper.height != height
+        || globalconf.wallpaper == NULL;
+    cairo_region_t *damage;
     cairo_surface_t *surface;
+    xcb_pixmap_t p = XCB_NONE;
     cairo_t *cr;
 
-    if (xcb_connection_has_error(c))
-        goto disconnect;
+    if (full)
+    {
+        p = root_wallpaper_create_pixmap(width, height);
+        if (p == XCB_NONE)
+            return false;
+        surface = cairo_xcb_surface_create(globalconf.connection, p, draw_default_visual(screen), width, height);
+    }
+    else
+        surface = globalconf.wallpaper;
 
-    /* Create a pixmap and make sure it is already created, because we are going
-     * to use it from the other X11 connection (Juggling with X11 connections
-     * is a really, really bad idea).
-     */
-    xcb_create_pixmap(c, screen->root_depth, p, screen->root, width, height);
-    xcb_aux_sync(c);
+    damage = cairo_region_create_rectangle(&root_rect);
+    if (region)
+        cairo_region_intersect(damage, (cairo_region_t *) region);
 
     /* Now paint to the picture from the main connection so that cairo sees that
      * it can tell the X server to copy between the (possible) old pixmap and
      * the new one directly and doesn't need GetImage and PutImage.
      */
-    surface = cairo_xcb_surface_create(globalconf.connection, p, draw_default_visual(screen), width, height);
     cr = cairo_create(surface);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    if (full && cairo_region_contains_rectangle(damage, &root_rect) != CAIRO_REGION_OVERLAP_IN)
+    {
+        /* The new pixmap has undefined content. Keep the old wallpaper outside
+         * of the damaged area, and use black where there is none.
+         */
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_paint(cr);
+        if (globalconf.wallpaper)
+        {
+            /* OVER leaves the black where the old wallpaper is too small */
+            cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+            cairo_set_source_surface(cr, globalconf.wallpaper, 0, 0);
+            cairo_paint(cr);
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        }
+    }
+    for (int i = 0; i < cairo_region_num_rectangles(damage); i++)
+    {
+        cairo_rectangle_int_t rect;
+        cairo_region_get_rectangle(damage, i, &rect);
+        cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+        globalconf.stats.wallpaper_pixels += (uint64_t) rect.width * rect.height;
+    }
+    cairo_clip(cr);
     /* Paint the pattern to the surface */
     cairo_set_source(cr, pattern);
-    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
     cairo_paint(cr);
     cairo_destroy(cr);
     cairo_surface_flush(surface);
-    xcb_aux_sync(globalconf.connection);
-
-    /* Change the wallpaper, without sending us a PropertyNotify event */
-    xcb_grab_server(globalconf.connection);
-    xcb_change_window_attributes(globalconf.connection,
-                                 globalconf.screen->root,
-                                 XCB_CW_EVENT_MASK,
-                                 (uint32_t[]) { 0 });
-    root_set_wallpaper_pixmap(c, p);
-    xcb_change_window_attributes(globalconf.connection,
-                                 globalconf.screen->root,
-                                 XCB_CW_EVENT_MASK,
-                                 ROOT_WINDOW_EVENT_MASK);
-    xcb_ungrab_server(globalconf.connection);
-
-    /* Make sure our pixmap is not destroyed when we disconnect. */
-    xcb_set_close_down_mode(c, XCB_CLOSE_DOWN_RETAIN_PERMANENT);
+
+    if (full)
+    {
+        /* The helper connection must only see the pixmap once it is painted */
+        xcb_aux_sync(globalconf.connection);
+
+        /* Change the wallpaper, without sending us a PropertyNotify event */
+        xcb_grab_server(globalconf.connection);
+        xcb_change_window_attributes(globalconf.connection,
+                                     globalconf.screen->root,
+                                     XCB_CW_EVENT_MASK,
+                                     (uint32_t[]) { 0 });
+        root_set_wallpaper_pixmap(root_wallpaper.connection, p);
+        xcb_change_window_attributes(globalconf.connection,
+                                     globalconf.screen->root,
+                                     XCB_CW_EVENT_MASK,
+                                     ROOT_WINDOW_EVENT_MASK);
+        xcb_ungrab_server(globalconf.connection);
+        xcb_flush(root_wallpaper.connection);
+
+        root_wallpaper.pixmap = p;
+        root_wallpaper.width = width;
+        root_wallpaper.height = height;
+
+        cairo_surface_destroy(globalconf.wallpaper);
+        globalconf.wallpaper = surface;
+        globalconf.stats.wallpaper_full++;
+    }
+    else
+    {
+        /* The pixmap stays the same, so just show the new content */
+        for (int i = 0; i < cairo_region_num_rectangles(damage); i++)
+        {
+            cairo_rectangle_int_t rect;
+            cairo_region_get_rectangle(damage, i, &rect);
+            xcb_clear_area(globalconf.connection, 0, screen->root,
+                           rect.x, rect.y, rect.width, rect.height);
+        }
+    }
+
+    cairo_region_destroy(damage);
+    globalconf.stats.wallpaper_updates++;
 
     /* Tell Lua that the wallpaper changed */
-    cairo_surface_destroy(globalconf.wallpaper);
-    globalconf.wallpaper = surface;
-    signal_object_emit(L, &global_signals, "wallpaper_changed", 0);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("wallpaper_changed"), 0);
 
-    result = true;
-disconnect:
-    xcb_aux_sync(c);
-    xcb_disconnect(c);
-    return result;
+    return true;
 }
 
 void
@@ -159,6 +306,7 @@ root_update_wallpaper(void)
 
     if (!prop_r || !prop_r->value_len)
     {
+        root_wallpaper_forget();
         p_delete(&prop_r);
         return;
     }
@@ -170,6 +318,10 @@ root_update_wallpaper(void)
         return;
     }
 
+    /* Somebody else set a wallpaper, so ours cannot be updated in place */
+    if (*rootpix != root_wallpaper.pixmap)
+        root_wallpaper_forget();
+
     geom_c = xcb_get_geometry_unchecked(globalconf.connection, *rootpix);
     geom_r = xcb_get_geometry_reply(globalconf.connection, geom_c, NULL);
     if (!geom_r)
@@ -298,7 +450,7 @@ luaA_root_keys(lua_State *L)
         luaA_checktable(L, 1);
 
         foreach(key, globalconf.keys)
-            luaA_object_unref(L, *key);
+            luaA_object_unref_class(L, *key);
 
         key_array_wipe(&globalconf.keys);
         key_array_init(&globalconf.keys);
@@ -338,14 +490,14 @@ luaA_root_buttons(lua_State *L)
         luaA_checktable(L, 1);
 
         foreach(button, globalconf.buttons)
-            luaA_object_unref(L, *button);
+            luaA_object_unref_class(L, *button);
 
         button_array_wipe(&globalconf.buttons);
         button_array_init(&globalconf.buttons);
 
         lua_pushnil(L);
         while(lua_next(L, 1))
-            button_array_append(&globalconf.buttons, luaA_object_ref(L, -1));
+            button_array_append(&globalconf.buttons, luaA_object_ref_class(L, -1, &button_class));
 
         return 1;
     }
@@ -410,18 +562,53 @@ luaA_root_drawins(lua_State *L)
 }
 
 /** Get the wallpaper as a cairo surface or set it as a cairo pattern.
+ *
+ * When setting the wallpaper, a list of areas can be given. Only these parts
+ * of the wallpaper are then repainted, which is much cheaper than replacing
+ * the whole wallpaper when only a single screen changed.
  *
  * @param pattern A cairo pattern as light userdata
+ * @tparam[opt] table areas A list of tables with `x`, `y`, `width` and
+ *   `height` keys. Everything is repainted if this is not given.
  * @return A cairo surface or nothing.
  * @function wallpaper
  */
 static int
 luaA_root_wallpaper(lua_State *L)
 {
-    if(lua_gettop(L) == 1)
+    if(lua_gettop(L) >= 1)
     {
-        cairo_pattern_t *pattern = (cairo_pattern_t *)lua_touserdata(L, -1);
-        lua_pushboolean(L, root_set_wallpaper(pattern));
+        cairo_pattern_t *pattern = (cairo_pattern_t *)lua_touserdata(L, 1);
+        cairo_region_t *region = NULL;
+
+        if(!lua_isnoneornil(L, 2))
+        {
+            luaA_checktable(L, 2);
+            region = cairo_region_create();
+            for(size_t i = 1; i <= luaA_rawlen(L, 2); i++)
+            {
+                cairo_rectangle_int_t rect;
+
+                lua_rawgeti(L, 2, i);
+                if(!lua_istable(L, -1))
+                {
+                    cairo_region_destroy(region);
+                    luaA_checktable(L, -1);
+                }
+                rect.x = floor(luaA_getopt_number(L, -1, "x", 0));
+                rect.y = floor(luaA_getopt_number(L, -1, "y", 0));
+                rect.width = ceil(luaA_getopt_number(L, -1, "width", 0));
+                rect.height = ceil(luaA_getopt_number(L, -1, "height", 0));
+                lua_pop(L, 1);
+
+                if(rect.width > 0 && rect.height > 0)
+                    cairo_region_union_rectangle(region, &rect);
+            }
+        }
+
+        lua_pushboolean(L, root_set_wallpaper(pattern, region));
+        if(region)
+            cairo_region_destroy(region);
         /* Don't return the wallpaper, it's too easy to get memleaks */
         return 1;
     }
@@ -98,7 +98,7 @@ spawn_monitor_timeout(gpointer sequence)
     if(spawn_sequence_remove(sequence))
     {
          signal_t *sig = signal_array_getbyid(&global_signals,
-                                              a_strhash((const unsigned char *) "spawn::timeout"));
+                                              SIGNAL_ID("spawn::timeout"));
          if(sig)
          {
              /* send a timeout signal */
@@ -130,7 +130,7 @@ spawn_monitor_event(SnMonitorEvent *event, void *data)
     lua_pushstring(L, sn_startup_sequence_get_id(sequence));
     lua_setfield(L, -2, "id");
 
-    const char *event_type_str = NULL;
+    signal_id_t event_id = 0;
 
     switch(event_type)
     {
@@ -138,7 +138,7 @@ spawn_monitor_event(SnMonitorEvent *event, void *data)
         /* ref the sequence for the array */
         sn_startup_sequence_ref(sequence);
         SnStartupSequence_array_append(&sn_waits, sequence);
-        event_type_str = "spawn::initiated";
+        event_id = SIGNAL_ID("spawn::initiated");
 
         /* Add a timeout function so we do not wait for this event to complete
          * for ever */
@@ -147,13 +147,13 @@ spawn_monitor_event(SnMonitorEvent *event, void *data)
         sn_startup_sequence_ref(sequence);
         break;
       case SN_MONITOR_EVENT_CHANGED:
-        event_type_str = "spawn::change";
+        event_id = SIGNAL_ID("spawn::change");
         break;
       case SN_MONITOR_EVENT_COMPLETED:
-        event_type_str = "spawn::completed";
+        event_id = SIGNAL_ID("spawn::completed");
         break;
       case SN_MONITOR_EVENT_CANCELED:
-        event_type_str = "spawn::canceled";
+        event_id = SIGNAL_ID("spawn::canceled");
         break;
     }
 
@@ -205,8 +205,7 @@ spawn_monitor_event(SnMonitorEvent *event, void *data)
     }
 
     /* send the signal */
-    signal_t *sig = signal_array_getbyid(&global_signals,
-                                         a_strhash((const unsigned char *) event_type_str));
+    signal_t *sig = signal_array_getbyid(&global_signals, event_id);
 
     if(sig)
     {
@@ -56,6 +56,80 @@ describe("gears.cache", function()
             assert.is.equal(num_calls, 2)
         end)
     end)
+
+    describe("Bounded", function()
+        local num_calls, c
+        before_each(function()
+            num_calls = 0
+            c = cache(function(a, b)
+                num_calls = num_calls + 1
+                return a + b
+            end, { max_size = 2 })
+        end)
+
+        it("Survives garbage collection", function()
+            c:get(1, 2)
+            collectgarbage("collect")
+            assert.is.equal(3, c:get(1, 2))
+            assert.is.equal(1, num_calls)
+        end)
+
+        it("Evicts the least recently used entry", function()
+            c:get(1, 2)
+            c:get(1, 3)
+            c:get(1, 2)
+            c:get(2, 2)
+            assert.is.equal(3, num_calls)
+
+            -- 1, 3 was evicted, but not 1, 2
+            c:get(1, 2)
+            assert.is.equal(3, num_calls)
+            c:get(1, 3)
+            assert.is.equal(4, num_calls)
+        end)
+
+        it("Counts hits, misses and evictions", function()
+            c:get(1, 2)
+            c:get(1, 2)
+            c:get(1, 3)
+            c:get(1, 4)
+            assert.is.same({ hits = 1, misses = 3, evictions = 1, size = 2, cost = 2 },
+                c:get_stats())
+        end)
+
+        it("Respects the cost", function()
+            c = cache(function(a)
+                num_calls = num_calls + 1
+                return string.rep("x", a)
+            end, { max_cost = 10, cost = function(s) return #s end })
+            c:get(4)
+            c:get(5)
+            assert.is.equal(9, c:get_stats().cost)
+            c:get(3)
+            assert.is.same({ hits = 0, misses = 3, evictions = 1, size = 2, cost = 8 },
+                c:get_stats())
+
+            -- An entry over the limit is still returned
+            assert.is.equal(20, #c:get(20))
+            assert.is.equal(1, c:get_stats().size)
+        end)
+
+        it("Expires entries", function()
+            c = cache(function()
+                num_calls = num_calls + 1
+            end, { ttl = 0 })
+            c:get()
+            c:get()
+            assert.is.equal(2, num_calls)
+
+            c = cache(function()
+                num_calls = num_calls + 1
+            end, { ttl = 3600 })
+            c:get()
+            c:get()
+            assert.is.equal(3, num_calls)
+        end)
+    end)
 end)
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
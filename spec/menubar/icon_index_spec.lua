@@ -0,0 +1,82 @@
+local gfs = require("gears.filesystem")
+local icon_index = require("menubar.icon_index")
+
+local function touch(path)
+    local f = assert(io.open(path, "w"))
+    f:close()
+end
+
+describe("menubar.icon_index", function()
+    local dir, cache_file
+
+    before_each(function()
+        dir = os.tmpname()
+        os.remove(dir)
+        assert(gfs.mkdir(dir .. "/sub"))
+        touch(dir .. "/a.png")
+        touch(dir .. "/b.svg")
+
+        cache_file = os.tmpname()
+        os.remove(cache_file)
+        icon_index.cache_file = cache_file
+        icon_index.clear()
+    end)
+
+    after_each(function()
+        for _, name in ipairs{ "a.png", "b.svg", "c.xpm", "sub" } do
+            os.remove(dir .. "/" .. name)
+        end
+        os.remove(dir)
+        os.remove(cache_file)
+        icon_index.cache_file = nil
+        icon_index.clear()
+    end)
+
+    it("lists the files of a directory", function()
+        assert.is.same({ ["a.png"] = true, ["b.svg"] = true }, icon_index.list(dir))
+        assert.is_true(icon_index.file_exists(dir, "a.png"))
+        assert.is_false(icon_index.file_exists(dir, "sub"))
+        assert.is_false(icon_index.file_exists(dir, "c.xpm"))
+    end)
+
+    it("handles missing directories", function()
+        assert.is_false(icon_index.list(dir .. "/missing"))
+        assert.is_false(icon_index.file_exists(dir .. "/missing", "a.png"))
+    end)
+
+    it("reuses saved listings", function()
+        local before = icon_index.get_stats()
+        icon_index.list(dir)
+        icon_index.save()
+        icon_index.clear()
+
+        assert.is_true(icon_index.file_exists(dir, "b.svg"))
+        local after = icon_index.get_stats()
+        assert.is.equal(before.listed + 1, after.listed)
+        assert.is.equal(before.reused + 1, after.reused)
+    end)
+
+    it("lists changed directories again", function()
+        icon_index.list(dir)
+        icon_index.save()
+        icon_index.clear()
+
+        -- Make sure that the modification time changes
+        local f = assert(io.popen("sleep 0.01"))
+        f:close()
+        touch(dir .. "/c.xpm")
+
+        local before = icon_index.get_stats()
+        assert.is_true(icon_index.file_exists(dir, "c.xpm"))
+        assert.is.equal(before.listed + 1, icon_index.get_stats().listed)
+    end)
+
+    it("does not save without a cache file", function()
+        icon_index.cache_file = false
+        icon_index.list(dir)
+        icon_index.save()
+        assert.is_nil(io.open(cache_file, "r"))
+    end)
+end)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -258,6 +258,29 @@ describe("wibox.hierarchy", function()
             -- Intermediate drew to 4, 0, 5, 2 (and so does new_intermediate)
             assert.is.same({ rect.x, rect.y, rect.width, rect.height }, { 4, 0, 5, 2 })
         end)
+
+        it("children are reused", function()
+            local old_children = instance:get_children()
+            local old_child = old_children[1]
+
+            -- Remove all children and add one again
+            parent.layout = function() end
+            parent:emit_signal("widget::layout_changed")
+            instance:update(context, parent, 15, 16)
+            assert.is.same(instance:get_children(), {})
+
+            parent.layout = function()
+                return { make_child(child, 5, 2, matrix.create_translate(4, 0)) }
+            end
+            parent:emit_signal("widget::layout_changed")
+            instance:update(context, parent, 15, 16)
+
+            assert.is.equal(old_children, instance:get_children())
+            assert.is.equal(old_child, instance:get_children()[1])
+            assert.is.equal(child, old_child:get_widget())
+            assert.is.same({ old_child:get_size() }, { 5, 2 })
+            assert.is.same(old_child:get_children(), {})
+        end)
     end)
 
     describe("widget counts", function()
@@ -309,6 +332,28 @@ describe("wibox.hierarchy", function()
             assert.is.equal(0, instance:get_count(unrelated))
         end)
 
+        it("after removing and re-adding children", function()
+            local function set_children(...)
+                local children = { ... }
+                parent.layout = function() return children end
+                parent:emit_signal("widget::layout_changed")
+                instance:update(context, parent, 10, 20)
+            end
+
+            set_children()
+            assert.is.equal(0, instance:get_count(child))
+            assert.is.equal(1, instance:get_count(parent))
+
+            set_children(make_child(child, 10, 20, matrix.identity),
+                make_child(intermediate, 10, 20, matrix.identity))
+            assert.is.equal(2, instance:get_count(child))
+
+            -- A child of size zero is not counted
+            set_children(make_child(child, 0, 20, matrix.identity))
+            assert.is.equal(0, instance:get_count(child))
+            assert.is.equal(1, instance:get_count(parent))
+        end)
+
         it("collectible", function()
             -- This test that hierarchy.count_widget() does not prevent garbage collection of the widget.
             local weak = setmetatable({}, { __mode = "v"})
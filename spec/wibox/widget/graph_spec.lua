@@ -0,0 +1,146 @@
+local graph = require("wibox.widget.graph")
+local cairo = require("lgi").cairo
+
+-- A context that records the columns instead of painting them
+local function recording_context()
+    local cr = { columns = {} }
+    function cr.get_target()
+        return { get_type = function() return "RECORDING" end }
+    end
+    function cr.move_to(_, x, y)
+        table.insert(cr.columns, { x = x, top = y })
+    end
+    for _, name in ipairs{ "set_line_width", "set_source", "paint", "save",
+                           "restore", "translate", "line_to", "rectangle",
+                           "stroke", "fill" } do
+        cr[name] = function() end
+    end
+    return cr
+end
+
+local function new_graph(args)
+    local widget = graph { width = args.width, height = args.height }
+    for k, v in pairs(args) do
+        widget["set_" .. k](widget, v)
+    end
+    return widget
+end
+
+local function assert_near(expected, actual)
+    assert.is_true(math.abs(expected - actual) < 1e-9,
+        "Expected " .. expected .. ", got " .. actual)
+end
+
+local function columns(widget, width, height)
+    local cr = recording_context()
+    widget:draw(nil, cr, width, height)
+    return cr.columns
+end
+
+-- Render to a PNG file and return its content
+local function render(widget, width, height)
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, width, height)
+    widget:draw(nil, cairo.Context(img), width, height)
+    local path = os.tmpname()
+    img:write_to_png(path)
+    local f = assert(io.open(path, "rb"))
+    local data = f:read("*a")
+    f:close()
+    os.remove(path)
+    return data
+end
+
+describe("wibox.widget.graph", function()
+    it("only keeps the samples it can show", function()
+        local widget = graph { width = 5, height = 10 }
+        widget:set_max_value(10)
+        for i = 1, 8 do
+            widget:add_value(i)
+        end
+
+        local cols = columns(widget, 5, 10)
+        assert.is.equal(5, #cols)
+        for age, col in ipairs(cols) do
+            assert_near(age - 0.5, col.x)
+            assert_near(10 - (9 - age), col.top)
+        end
+    end)
+
+    it("keeps the newest samples when resized", function()
+        local widget = graph { width = 10, height = 10 }
+        widget:set_max_value(10)
+        for i = 1, 10 do
+            widget:add_value(i)
+        end
+        widget:set_width(5)
+        widget:add_value(0)
+
+        local cols = columns(widget, 5, 10)
+        assert.is.equal(5, #cols)
+        assert_near(10, cols[1].top)
+        assert_near(0, cols[2].top)
+        assert_near(3, cols[5].top)
+    end)
+
+    it("scales down once the maximum is dropped", function()
+        local widget = graph { width = 5, height = 10 }
+        widget:set_scale(true)
+        widget:set_min_value(0)
+        widget:add_value(100)
+        for _ = 1, 4 do
+            widget:add_value(5)
+        end
+        assert_near(9.5, columns(widget, 5, 10)[1].top)
+
+        widget:add_value(5)
+        assert_near(0, columns(widget, 5, 10)[1].top)
+    end)
+
+    it("forgets everything when cleared", function()
+        local widget = graph { width = 5, height = 10 }
+        widget:add_value(1)
+        widget:clear()
+        assert.is.same({}, columns(widget, 5, 10))
+    end)
+
+    describe("incremental rendering", function()
+        local function compare(args, values)
+            local incremental = new_graph(args)
+            for i, v in ipairs(values) do
+                incremental:add_value(v)
+                if i % 3 ~= 0 then
+                    render(incremental, args.width, args.height)
+                end
+            end
+
+            local full = new_graph(args)
+            for _, v in ipairs(values) do
+                full:add_value(v)
+            end
+
+            assert.is.equal(render(full, args.width, args.height),
+                render(incremental, args.width, args.height))
+        end
+
+        local values = {}
+        for i = 1, 60 do
+            values[i] = (i * 7) % 11
+        end
+
+        it("lines", function()
+            compare({ width = 40, height = 20, max_value = 10 }, values)
+        end)
+
+        it("bars", function()
+            compare({ width = 40, height = 20, max_value = 10, step_width = 3,
+                      border_color = "#ffffff" }, values)
+        end)
+
+        it("spaced bars", function()
+            compare({ width = 40, height = 20, max_value = 10, step_width = 2,
+                      step_spacing = 1 }, values)
+        end)
+    end)
+end)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
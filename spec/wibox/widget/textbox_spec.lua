@@ -113,6 +113,43 @@ describe("wibox.widget.textbox", function()
             assert.is.equal(2, layout_changed)
         end)
     end)
+
+    describe("layout cache", function()
+        local context = { dpi = 96 }
+
+        it("shares layouts between textboxes", function()
+            widget:set_text("shared text")
+            local other = textbox("shared text", true)
+
+            local before = textbox.get_layout_cache_stats()
+            local w1, h1 = widget:fit(context, 200, 20)
+            local w2, h2 = other:fit(context, 200, 20)
+            local after = textbox.get_layout_cache_stats()
+
+            assert.is.equal(w1, w2)
+            assert.is.equal(h1, h2)
+            assert.is.equal(before.misses + 1, after.misses)
+            assert.is.equal(before.hits + 1, after.hits)
+        end)
+
+        it("distinguishes text and markup", function()
+            widget:set_text("<b>text</b>")
+            local other = textbox("<b>text</b>")
+            local w1 = widget:fit(context, 200, 20)
+            local w2 = other:fit(context, 200, 20)
+            assert.is_not.equal(w1, w2)
+        end)
+
+        it("is bounded", function()
+            textbox.set_layout_cache_size(2)
+            for i = 1, 10 do
+                widget:set_text("text " .. i)
+                widget:fit(context, 200, 20)
+            end
+            assert.is_true(textbox.get_layout_cache_stats().entries <= 4)
+            textbox.set_layout_cache_size(500)
+        end)
+    end)
 end)
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -43,10 +43,9 @@ stack_client_remove(client_t *c)
 void
 stack_client_push(client_t *c)
 {
+    /* This also marks the stack and its EWMH property as outdated */
     stack_client_remove(c);
     client_array_push(&globalconf.stack, c);
-    ewmh_update_net_client_list_stacking();
-    stack_windows();
 }
 
 /** Push the client at the end of the client stack.
@@ -57,8 +56,6 @@ stack_client_append(client_t *c)
 {
     stack_client_remove(c);
     client_array_append(&globalconf.stack, c);
-    ewmh_update_net_client_list_stacking();
-    stack_windows();
 }
 
 static bool need_stack_refresh = false;
@@ -69,42 +66,33 @@ stack_windows(void)
     need_stack_refresh = true;
 }
 
-/** Stack a window above another window, without causing errors.
- * \param w The window.
- * \param previous The window which should be below this window.
- */
-static void
-stack_window_above(xcb_window_t w, xcb_window_t previous)
-{
-    if (previous == XCB_NONE)
-        /* This would cause an error from the X server. Also, if we really
-         * changed the stacking order of all windows, they'd all have to redraw
-         * themselves. Doing it like this is better. */
-        return;
-
-    xcb_configure_window(globalconf.connection, w,
-                         XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE,
-                         (uint32_t[]) { previous, XCB_STACK_MODE_ABOVE });
-}
+/** The stacking order that was last sent to the X server, bottom to top */
+static window_array_t stack_current;
+/** The stacking order that stack_refresh() is computing, bottom to top */
+static window_array_t stack_wanted;
 
-/** Stack a client above.
+/** Stack a client and its transients above everything computed so far.
  * \param c The client.
- * \param previous The previous client on the stack.
- * \return The next-previous!
  */
-static xcb_window_t
-stack_client_above(client_t *c, xcb_window_t previous)
+static void
+stack_client_above(client_t *c)
 {
-    stack_window_above(c->frame_window, previous);
-
-    previous = c->frame_window;
+    window_array_append(&stack_wanted, c->frame_window);
 
-    /* stack transient window on top of their parents */
-    foreach(node, globalconf.stack)
-        if((*node)->transient_for == c)
-            previous = stack_client_above(*node, previous);
+    /* Stack transient windows on top of their parents, in the order in which
+     * they appear in the client stack. The list is nearly always sorted
+     * already, so an insertion sort is cheap here. */
+    for(int i = 1; i < c->transients.len; i++)
+    {
+        client_t *tc = c->transients.tab[i];
+        int j = i;
+        for(; j > 0 && c->transients.tab[j - 1]->stack_position > tc->stack_position; j--)
+            c->transients.tab[j] = c->transients.tab[j - 1];
+        c->transients.tab[j] = tc;
+    }
 
-    return previous;
+    foreach(tc, c->transients)
+        stack_client_above(*tc);
 }
 
 /** Stacking layout layers */
@@ -155,9 +143,169 @@ client_layer_translator(client_t *c)
     return WINDOW_LAYER_NORMAL;
 }
 
+/** A window and its position in a stacking order */
+typedef struct
+{
+    xcb_window_t window;
+    int position;
+} stack_entry_t;
+
+static int
+stack_entry_cmp(const void *a, const void *b)
+{
+    const stack_entry_t *x = a, *y = b;
+    if(x->window != y->window)
+        return x->window < y->window ? -1 : 1;
+    return x->position - y->position;
+}
+
+static int
+stack_entry_window_cmp(const void *a, const void *b)
+{
+    const stack_entry_t *x = a, *y = b;
+    if(x->window != y->window)
+        return x->window < y->window ? -1 : 1;
+    return 0;
+}
+
+/** Get a copy of a stacking order, sorted by window id.
+ * \param order The stacking order.
+ * \return A new array that must be freed by the caller.
+ */
+static stack_entry_t *
+stack_entries_sorted(window_array_t *order)
+{
+    stack_entry_t *entries = p_new(stack_entry_t, order->len + 1);
+    for(int i = 0; i < order->len; i++)
+    {
+        entries[i].window = order->tab[i];
+        entries[i].position = i;
+    }
+    qsort(entries, order->len, sizeof(*entries), stack_entry_cmp);
+    return entries;
+}
+
+/** Remove all but the last occurrence of every window from the wanted order.
+ * A transient that has a layer of its own is stacked twice, and the second
+ * ConfigureWindow request used to win.
+ */
+static void
+stack_wanted_remove_duplicates(void)
+{
+    stack_entry_t *entries = stack_entries_sorted(&stack_wanted);
+    bool found = false;
+
+    for(int i = 0; i + 1 < stack_wanted.len; i++)
+        if(entries[i].window == entries[i + 1].window)
+        {
+            stack_wanted.tab[entries[i].position] = XCB_NONE;
+            found = true;
+        }
+
+    if(found)
+    {
+        int len = 0;
+        foreach(w, stack_wanted)
+            if(*w != XCB_NONE)
+                stack_wanted.tab[len++] = *w;
+        stack_wanted.len = len;
+    }
+
+    p_delete(&entries);
+}
+
+/** Send the ConfigureWindow requests that turn the current stacking order
+ * into the wanted one.
+ *
+ * The windows whose previous positions form a longest increasing subsequence
+ * of the wanted order are already correctly stacked relative to each other,
+ * so only the other windows have to be moved. Each of those is stacked
+ * directly above its new lower neighbour.
+ *
+ * \return The number of requests that were sent.
+ */
+static int
+stack_apply(void)
+{
+    int len = stack_wanted.len, lis_len = 0, first_kept = -1, requests = 0;
+    stack_entry_t *current = stack_entries_sorted(&stack_current);
+    /* Previous position of every wanted window, -1 if it is new */
+    int *previous = p_new(int, len + 1);
+    /* tails[k] is the index of the smallest tail of an increasing
+     * subsequence of length k + 1, parent[] links them backwards */
+    int *tails = p_new(int, len + 1);
+    int *parent = p_new(int, len + 1);
+    bool *kept = p_new(bool, len + 1);
+
+    for(int i = 0; i < len; i++)
+    {
+        stack_entry_t key = { .window = stack_wanted.tab[i] };
+        stack_entry_t *found = bsearch(&key, current, stack_current.len,
+                                       sizeof(*current), stack_entry_window_cmp);
+        previous[i] = found ? found->position : -1;
+    }
+
+    for(int i = 0; i < len; i++)
+    {
+        if(previous[i] < 0)
+            continue;
+
+        int lo = 0, hi = lis_len;
+        while(lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if(previous[tails[mid]] < previous[i])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        parent[i] = lo > 0 ? tails[lo - 1] : -1;
+        tails[lo] = i;
+        if(lo == lis_len)
+            lis_len++;
+    }
+
+    if(lis_len > 0)
+        for(int i = tails[lis_len - 1]; i >= 0; i = parent[i])
+        {
+            kept[i] = true;
+            first_kept = i;
+        }
+
+    for(int i = 0; i < len; i++)
+    {
+        if(kept[i])
+            continue;
+
+        if(i > 0)
+            xcb_configure_window(globalconf.connection, stack_wanted.tab[i],
+                                 XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE,
+                                 (uint32_t[]) { stack_wanted.tab[i - 1], XCB_STACK_MODE_ABOVE });
+        else if(first_kept >= 0)
+            xcb_configure_window(globalconf.connection, stack_wanted.tab[i],
+                                 XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE,
+                                 (uint32_t[]) { stack_wanted.tab[first_kept], XCB_STACK_MODE_BELOW });
+        else
+            /* Nothing to stack the bottom window relative to. Also, if we
+             * really changed the stacking order of all windows, they'd all
+             * have to redraw themselves. Leaving it alone is better. */
+            continue;
+
+        requests++;
+    }
+
+    p_delete(&kept);
+    p_delete(&parent);
+    p_delete(&tails);
+    p_delete(&previous);
+    p_delete(&current);
+
+    return requests;
+}
+
 /** Restack clients.
- * \todo It might be worth stopping to restack everyone and only stack `c'
- * relatively to the first matching in the list.
+ * The wanted stacking order is computed from scratch, but only the windows
+ * that actually moved get a ConfigureWindow request.
  */
 void
 stack_refresh()
@@ -165,35 +313,44 @@ stack_refresh()
     if(!need_stack_refresh)
         return;
 
-    xcb_window_t next = XCB_NONE;
+    stack_wanted.len = 0;
+
+    for(int i = 0; i < globalconf.stack.len; i++)
+        globalconf.stack.tab[i]->stack_position = i;
 
     /* stack desktop windows */
     for(window_layer_t layer = WINDOW_LAYER_DESKTOP; layer < WINDOW_LAYER_BELOW; layer++)
         foreach(node, globalconf.stack)
             if(client_layer_translator(*node) == layer)
-                next = stack_client_above(*node, next);
+                stack_client_above(*node);
 
     /* first stack not ontop drawin window */
     foreach(drawin, globalconf.drawins)
         if(!(*drawin)->ontop)
-        {
-            stack_window_above((*drawin)->window, next);
-            next = (*drawin)->window;
-        }
+            window_array_append(&stack_wanted, (*drawin)->window);
 
     /* then stack clients */
     for(window_layer_t layer = WINDOW_LAYER_BELOW; layer < WINDOW_LAYER_COUNT; layer++)
         foreach(node, globalconf.stack)
             if(client_layer_translator(*node) == layer)
-                next = stack_client_above(*node, next);
+                stack_client_above(*node);
 
     /* then stack ontop drawin window */
     foreach(drawin, globalconf.drawins)
         if((*drawin)->ontop)
-        {
-            stack_window_above((*drawin)->window, next);
-            next = (*drawin)->window;
-        }
+            window_array_append(&stack_wanted, (*drawin)->window);
+
+    stack_wanted_remove_duplicates();
+
+    int requests = stack_apply();
+    globalconf.stats.stack_refresh++;
+    globalconf.stats.stack_requests += requests;
+    globalconf.stats.stack_last_requests = requests;
+
+    /* What we wanted is what the X server has now */
+    window_array_t tmp = stack_current;
+    stack_current = stack_wanted;
+    stack_wanted = tmp;
 
     need_stack_refresh = false;
 }
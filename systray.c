@@ -204,23 +204,30 @@ systray_process_client_message(xcb_client_message_event_t *ev)
     return ret;
 }
 
-/** Check if a window is a KDE tray.
+/** Send the request to check if a window is a KDE tray.
  * \param w The window to check.
- * \return True if it is, false otherwise.
+ * \return The cookie for systray_iskdedockapp_reply().
+ */
+xcb_get_property_cookie_t
+systray_iskdedockapp_unchecked(xcb_window_t w)
+{
+    /* Check if that is a KDE tray because it does not respect fdo standards,
+     * thanks KDE. */
+    return xcb_get_property_unchecked(globalconf.connection, false, w,
+                                      _KDE_NET_WM_SYSTEM_TRAY_WINDOW_FOR,
+                                      XCB_ATOM_WINDOW, 0, 1);
+}
+
+/** Check the reply of systray_iskdedockapp_unchecked().
+ * \param kde_check_q The cookie of the request.
+ * \return True if the window is a KDE dock application.
  */
 bool
-systray_iskdedockapp(xcb_window_t w)
+systray_iskdedockapp_reply(xcb_get_property_cookie_t kde_check_q)
 {
-    xcb_get_property_cookie_t kde_check_q;
     xcb_get_property_reply_t *kde_check;
     bool ret;
 
-    /* Check if that is a KDE tray because it does not respect fdo standards,
-     * thanks KDE. */
-    kde_check_q = xcb_get_property_unchecked(globalconf.connection, false, w,
-                                             _KDE_NET_WM_SYSTEM_TRAY_WINDOW_FOR,
-                                             XCB_ATOM_WINDOW, 0, 1);
-
     kde_check = xcb_get_property_reply(globalconf.connection, kde_check_q, NULL);
 
     /* it's a KDE systray ?*/
@@ -263,7 +270,7 @@ void
 luaA_systray_invalidate(void)
 {
     lua_State *L = globalconf_get_lua_State();
-    signal_object_emit(L, &global_signals, "systray::update", 0);
+    signal_object_emit(L, &global_signals, SIGNAL_ID("systray::update"), 0);
 
     /* Unmap now if the systray became empty */
     if(systray_num_visible_entries() == 0)
@@ -8,6 +8,7 @@ local lgi = require 'lgi'
 local Gdk = lgi.require('Gdk')
 local Gtk = lgi.require('Gtk')
 local Gio = lgi.require('Gio')
+local GdkPixbuf = lgi.require('GdkPixbuf')
 Gtk.init()
 
 local function open_window(class, title, options)
@@ -29,6 +30,12 @@ local function open_window(class, title, options)
         }
         window:set_geometry_hints(nil, geom, Gdk.WindowHints.RESIZE_INC)
     end
+    if options.icon then
+        -- The same icon for all windows asking for one
+        local icon = GdkPixbuf.Pixbuf.new(GdkPixbuf.Colorspace.RGB, true, 8, 32, 32)
+        icon:fill(0xff000080)
+        window:set_icon(icon)
+    end
     window:set_wmclass(class, class)
     window:show_all()
 end
@@ -106,7 +113,7 @@ local function get_snid(sn_rules, callback)
     return snid
 end
 
-return function(class, title, sn_rules, callback, resize_increment)
+return function(class, title, sn_rules, callback, resize_increment, icon)
     class = class or "test_app"
     title = title or "Awesome test client"
 
@@ -120,6 +127,9 @@ return function(class, title, sn_rules, callback, resize_increment)
     if resize_increment then
         options = options .. "resize_increment,"
     end
+    if icon then
+        options = options .. "icon,"
+    end
     local data = class .. "\n" .. title .. "\n" .. options .. "\n"
     local success, msg = pipe:write_all(data)
     assert(success, tostring(msg))
@@ -0,0 +1,73 @@
+--- Check that banning only looks at the clients whose visibility may have
+-- changed.
+
+local runner = require("_runner")
+local test_client = require("_client")
+
+local before
+
+local steps = {
+    -- Spawn some clients
+    function(count)
+        if count == 1 then
+            for _ = 1, 3 do
+                test_client()
+            end
+        end
+        if #client.get() >= 3 then
+            return true
+        end
+    end,
+
+    -- Switch to an empty tag
+    function()
+        before = awesome.stats().banning
+        screen.primary.tags[2]:view_only()
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().banning
+        assert(after.count == before.count + 1, after.count - before.count)
+        assert(after.last_clients == 3, after.last_clients)
+        for _, c in ipairs(client.get()) do
+            assert(not c:isvisible())
+        end
+        return true
+    end,
+
+    -- Switch back and minimize one client
+    function()
+        screen.primary.tags[1]:view_only()
+        return true
+    end,
+
+    function()
+        before = awesome.stats().banning
+        client.get()[1].minimized = true
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().banning
+        assert(after.count == before.count + 1, after.count - before.count)
+        assert(after.last_clients == 1, after.last_clients)
+        before = after
+        return true
+    end,
+
+    -- Without any changes, nothing is checked
+    function(count)
+        if count < 3 then
+            return
+        end
+        local after = awesome.stats().banning
+        assert(after.count == before.count, after.count - before.count)
+        assert(after.clients == before.clients)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -3,8 +3,13 @@
 
 local runner = require("_runner")
 local awful = require("awful")
+local wibox = require("wibox")
 local GLib = require("lgi").GLib
+local cairo = require("lgi").cairo
+local gears_surface = require("gears.surface")
 local create_wibox = require("_wibox_helper").create_wibox
+local test_client = require("_client")
+local icon_index = require("menubar.icon_index")
 
 local BENCHMARK_EXACT = os.getenv("BENCHMARK_EXACT")
 if not BENCHMARK_EXACT then
@@ -24,8 +29,19 @@ do
         return elapsed / iter, elapsed
     end
 
+    -- Memory allocated by a single call, in KiB
+    local function allocated(f)
+        collectgarbage("collect")
+        collectgarbage("stop")
+        local before = collectgarbage("count")
+        f()
+        local after = collectgarbage("count")
+        collectgarbage("restart")
+        return after - before
+    end
+
     local timer_benchmark = GLib.Timer()
-    benchmark = function(f, msg)
+    benchmark = function(f, msg, count_allocations)
         timer_benchmark:start()
         local iters = 1
         local time_per_iter, time_total = measure(f, iters)
@@ -37,6 +53,9 @@ do
         end
         print(string.format("%20s: %-10.6g sec/iter (%3d iters, %.4g sec for benchmark)",
                             msg, time_per_iter, iters, timer_benchmark:elapsed()))
+        if count_allocations then
+            print(string.format("%20s: %-10.6g KiB allocated/iter", msg, allocated(f)))
+        end
     end
 end
 
@@ -49,13 +68,49 @@ local function create_and_draw_wibox()
     do_pending_repaint()
 end
 
-local _, textclock = create_wibox()
+local main_wibox, textclock, _, _, _, main_layout = create_wibox()
+local tasklist = main_layout:get_children()[2]
 
 local function relayout_textclock()
     textclock:emit_signal("widget::layout_changed")
     do_pending_repaint()
 end
 
+-- Many similar widgets, like a tasklist with lots of entries
+local many_widgets_layout = wibox.layout.fixed.horizontal()
+for i = 1, 60 do
+    many_widgets_layout:add(wibox.widget.textbox("entry " .. i))
+end
+local many_widgets_wibox = wibox({ width = 1024, height = 20, visible = true })
+many_widgets_wibox:set_widget(many_widgets_layout)
+
+-- Count the layouts, so that the benchmark notices when nothing is laid out
+local many_widgets_layouts = 0
+do
+    local layout = many_widgets_layout.layout
+    rawset(many_widgets_layout, "layout", function(...)
+        many_widgets_layouts = many_widgets_layouts + 1
+        return layout(...)
+    end)
+end
+
+local function relayout_many_widgets()
+    many_widgets_layout:emit_signal("widget::layout_changed")
+    do_pending_repaint()
+end
+
+-- Move the pointer across the widgets, like a mouse::move for every pixel
+local function pointer_sweep()
+    for x = 0, many_widgets_wibox.width - 1 do
+        many_widgets_wibox:find_widgets(x, 10)
+    end
+end
+
+local function relayout_tasklist()
+    tasklist:emit_signal("widget::layout_changed")
+    do_pending_repaint()
+end
+
 local function redraw_textclock()
     textclock:emit_signal("widget::redraw_needed")
     do_pending_repaint()
@@ -71,12 +126,219 @@ local function e2e_tag_switch()
     do_pending_repaint()
 end
 
+local signal_drawin = drawin({})
+signal_drawin:connect_signal("benchmark::connected", function() end)
+
+local function emit_signal_unconnected()
+    for _ = 1, 1000 do
+        signal_drawin:emit_signal("benchmark::unconnected", 42)
+    end
+end
+
+local function read_drawin_properties()
+    for _ = 1, 1000 do
+        local _ = signal_drawin.visible, signal_drawin.ontop, signal_drawin.x,
+            signal_drawin.valid, signal_drawin.window
+    end
+end
+
+local function read_client_properties()
+    local c = client.get()[1]
+    for _ = 1, 1000 do
+        local _ = c.name, c.floating, c.screen, c.valid, c.window
+    end
+end
+
+-- Setting the root buttons unrefs the old ones and refs the new ones. With the
+-- same button everywhere, all but one of these only change its count.
+local root_button = button({})
+local many_root_buttons = {}
+for i = 1, 1000 do
+    many_root_buttons[i] = root_button
+end
+
+local function set_root_buttons()
+    root.buttons(many_root_buttons)
+end
+
+local function toggle_client_tags()
+    local c = client.get()[1]
+    local tags = c.screen.tags
+    for _ = 1, 1000 do
+        c:tags({ tags[1], tags[2] })
+        c:tags({ tags[1] })
+    end
+end
+
+-- A translucent 256x256 icon, like the ones applications ship
+local icon_path = os.tmpname()
+do
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, 256, 256)
+    local cr = cairo.Context(img)
+    local pattern = cairo.LinearPattern(0, 0, 256, 256)
+    pattern:add_color_stop_rgba(0, 1, 0, 0, 0.2)
+    pattern:add_color_stop_rgba(1, 0, 0, 1, 0.9)
+    cr:set_source(pattern)
+    cr:paint()
+    img:write_to_png(icon_path)
+end
+
+local function load_icon()
+    gears_surface.load_uncached(icon_path)
+end
+
+-- Like an animated popup growing and shrinking
+local resized_wibox = wibox({ width = 200, height = 100 })
+resized_wibox:set_bg("#ff0000")
+
+local function resize_wibox()
+    for i = 1, 1000 do
+        resized_wibox.width = 200 + i % 40
+        resized_wibox.height = 100 + i % 20
+        do_pending_repaint()
+    end
+end
+
+-- A terminal printing its title at every frame
+local function title_spam()
+    local clients = client.get()
+    local c = clients[#clients]
+    for i = 1, 30 do
+        c.name = "title " .. i
+        do_pending_repaint()
+    end
+end
+
+local function emit_signal_connected()
+    for _ = 1, 1000 do
+        signal_drawin:emit_signal("benchmark::connected", 42)
+    end
+end
+
 benchmark(create_and_draw_wibox, "create&draw wibox")
 benchmark(update_textclock, "update textclock")
-benchmark(relayout_textclock, "relayout textclock")
+benchmark(relayout_textclock, "relayout textclock", true)
+benchmark(relayout_many_widgets, "relayout 60 widgets", true)
+assert(many_widgets_layouts > 0, "the 60 widgets were not laid out")
+benchmark(pointer_sweep, "1024 pointer hits")
+assert(#many_widgets_wibox:find_widgets(10, 10) > 0, "no widget under the pointer")
 benchmark(redraw_textclock, "redraw textclock")
 benchmark(e2e_tag_switch, "tag switch")
+benchmark(emit_signal_unconnected, "1000 emits, no listener")
+benchmark(emit_signal_connected, "1000 emits, 1 listener")
+benchmark(read_drawin_properties, "5000 drawin reads")
+do
+    local old_root_buttons = root.buttons()
+    benchmark(set_root_buttons, "2000 button (un)refs")
+    root.buttons(old_root_buttons)
+end
+benchmark(load_icon, "load 256x256 icon")
+benchmark(resize_wibox, "1000 wibox resizes")
+os.remove(icon_path)
+
+local steps = {
+    function(count)
+        if count == 1 then
+            test_client()
+        end
+        if #client.get() > 0 then
+            benchmark(read_client_properties, "5000 client reads")
+            benchmark(toggle_client_tags, "2000 client tag sets")
+            benchmark(e2e_tag_switch, "tag switch w/ client")
+
+            -- Invisible wiboxes are not laid out at all
+            main_wibox.visible = true
+            local stats = wibox.widget.textbox.get_layout_cache_stats()
+            benchmark(relayout_tasklist, "relayout tasklist", true)
+            local after = wibox.widget.textbox.get_layout_cache_stats()
+            local hits, misses = after.hits - stats.hits, after.misses - stats.misses
+            print(string.format("%20s: %d hits, %d misses in the text layout cache",
+                                "relayout tasklist", hits, misses))
+            assert(hits + misses > 0, "the tasklist was not laid out")
+            main_wibox.visible = false
+            return true
+        end
+    end,
+}
+
+-- Get to 200 clients in small batches, so that no step has to wait for long
+local client_count = 200
+for n = 10, client_count, 10 do
+    table.insert(steps, function(count)
+        if count == 1 then
+            for _ = #client.get() + 1, n do
+                test_client()
+            end
+        end
+        if #client.get() >= n then
+            return true
+        end
+    end)
+end
+
+table.insert(steps, function()
+    benchmark(title_spam, "30 titles, " .. client_count .. " clients", true)
+    return true
+end)
+
+-- Generate the menubar entries from scratch, once without and once with the
+-- saved icon index
+local menu_cache_file = os.tmpname()
+os.remove(menu_cache_file)
+icon_index.cache_file = menu_cache_file
+local menu_generated
+
+local function start_menu_gen(msg)
+    -- Also forget the icons that menubar.utils already looked up
+    package.loaded["menubar.utils"] = nil
+    package.loaded["menubar.menu_gen"] = nil
+    local menu_gen = require("menubar.menu_gen")
+
+    menu_generated = false
+    local timer_menu = GLib.Timer()
+    local before = icon_index.get_stats()
+    menu_gen.generate(function(entries)
+        local after = icon_index.get_stats()
+        print(string.format("%20s: %-10.6g sec (%d entries, %d dirs listed, %d reused)",
+                            msg, timer_menu:elapsed(), #entries,
+                            after.listed - before.listed,
+                            after.reused - before.reused))
+        menu_generated = true
+    end)
+end
+
+-- The generation runs asynchronously and may take longer than a single step
+-- is allowed to wait for.
+local function wait_for_menu_gen()
+    for _ = 1, 20 do
+        table.insert(steps, function(count)
+            return menu_generated or count >= 4 or nil
+        end)
+    end
+    table.insert(steps, function()
+        assert(menu_generated, "menu generation did not finish")
+        return true
+    end)
+end
+
+table.insert(steps, function()
+    start_menu_gen("menu gen, cold")
+    return true
+end)
+wait_for_menu_gen()
+
+table.insert(steps, function()
+    start_menu_gen("menu gen, warm")
+    return true
+end)
+wait_for_menu_gen()
+
+table.insert(steps, function()
+    os.remove(menu_cache_file)
+    icon_index.cache_file = nil
+    return true
+end)
 
-runner.run_steps({ function() return true end })
+runner.run_steps(steps)
 
 -- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
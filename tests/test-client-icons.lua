@@ -0,0 +1,79 @@
+--- Check that clients with the same icon share it, and that each size is only
+-- decoded once for all of them.
+
+local runner = require("_runner")
+local test_client = require("_client")
+
+local before
+
+local steps = {
+    -- Spawn some clients with the same icon
+    function(count)
+        if count == 1 then
+            before = awesome.stats().icons
+            for _ = 1, 3 do
+                test_client(nil, nil, nil, nil, nil, true)
+            end
+        end
+        local with_icon = 0
+        for _, c in ipairs(client.get()) do
+            if #c.icon_sizes > 0 then
+                with_icon = with_icon + 1
+            end
+        end
+        if with_icon >= 3 then
+            return true
+        end
+    end,
+
+    function()
+        local after = awesome.stats().icons
+        local sizes = #client.get()[1].icon_sizes
+
+        -- All clients share the same icons
+        assert(after.count == before.count + sizes, after.count - before.count)
+        assert(after.references == before.references + 3 * sizes,
+            after.references - before.references)
+        assert(after.raw_bytes > before.raw_bytes)
+
+        -- The default configuration may already have decoded some sizes for
+        -- the tasklist and the titlebars, so start from a first read.
+        local clients = client.get()
+        assert(clients[1].icon)
+        local first = awesome.stats().icons
+
+        -- The other clients share the decoded icon
+        for _, c in ipairs(clients) do
+            assert(c.icon)
+        end
+        local decoded = awesome.stats().icons
+        assert(decoded.decoded == first.decoded, decoded.decoded - first.decoded)
+        assert(decoded.decoded_bytes == first.decoded_bytes)
+
+        -- Each size is decoded at most once for all clients
+        assert(decoded.decoded - before.decoded <= sizes,
+            decoded.decoded - before.decoded)
+        return true
+    end,
+
+    -- Killing the clients releases the icons
+    function(count)
+        if count == 1 then
+            for _, c in ipairs(client.get()) do
+                c:kill()
+            end
+        end
+        -- Icons are released once the client objects are collected
+        collectgarbage("collect")
+        local after = awesome.stats().icons
+        if #client.get() == 0 and after.count == before.count then
+            assert(after.references == before.references)
+            assert(after.raw_bytes == before.raw_bytes)
+            return true
+        end
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,162 @@
+/*
+ * test-draw-kernels.c - check the pixel conversion kernels
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+/* Every kernel set the CPU supports must give exactly c * a / 255 rounded
+ * down for all color/alpha pairs, also for rows whose length does not fit the
+ * vector width, and must not write past the end of a row.
+ */
+
+#include "draw_kernels.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* All color/alpha pairs */
+#define PIXELS (256 * 256)
+/* Canary pixels after the end of a row */
+#define CANARY 16
+#define CANARY_VALUE 0xdeadbeef
+
+static int failures;
+
+static void
+source_pixel(int i, uint8_t *r, uint8_t *g, uint8_t *b, uint8_t *a)
+{
+    *a = i >> 8;
+    *r = i & 0xff;
+    *g = 255 - *r;
+    *b = (*r * 7) & 0xff;
+}
+
+static uint32_t
+expected_argb32(int i)
+{
+    uint8_t r, g, b, a;
+    source_pixel(i, &r, &g, &b, &a);
+    return ((uint32_t) a << 24) | (r * a / 255 << 16) | (g * a / 255 << 8) | (b * a / 255);
+}
+
+static uint32_t
+expected_rgb24(int i)
+{
+    uint8_t r, g, b, a;
+    source_pixel(i, &r, &g, &b, &a);
+    return ((uint32_t) r << 16) | (g << 8) | b;
+}
+
+static void
+check_row(const char *kernels, const char *kernel, const uint32_t *dst,
+          int first, int len, uint32_t (*expected)(int))
+{
+    for(int i = 0; i < len; i++)
+        if(dst[i] != expected(first + i))
+        {
+            fprintf(stderr, "%s %s: pixel %d of a row of %d: 0x%08x instead of 0x%08x\n",
+                    kernels, kernel, first + i, len, dst[i], expected(first + i));
+            failures++;
+            return;
+        }
+    for(int i = len; i < len + CANARY; i++)
+        if(dst[i] != CANARY_VALUE)
+        {
+            fprintf(stderr, "%s %s: wrote past the end of a row of %d\n",
+                    kernels, kernel, len);
+            failures++;
+            return;
+        }
+}
+
+/* Convert the pixels from first on, in a row of len pixels */
+static void
+check_kernels(const draw_kernels_t *k, int first, int len)
+{
+    static uint32_t argb[PIXELS], dst[PIXELS + CANARY];
+    static uint8_t rgba[4 * PIXELS], rgb[3 * PIXELS];
+    static bool initialized;
+
+    if(!initialized)
+    {
+        for(int i = 0; i < PIXELS; i++)
+        {
+            uint8_t r, g, b, a;
+            source_pixel(i, &r, &g, &b, &a);
+            argb[i] = ((uint32_t) a << 24) | (r << 16) | (g << 8) | b;
+            memcpy(rgba + 4 * i, (uint8_t[]) { r, g, b, a }, 4);
+            memcpy(rgb + 3 * i, (uint8_t[]) { r, g, b }, 3);
+        }
+        initialized = true;
+    }
+
+    for(int i = 0; i < len + CANARY; i++)
+        dst[i] = CANARY_VALUE;
+    k->premultiply_argb32(dst, argb + first, len);
+    check_row(k->name, "premultiply_argb32", dst, first, len, expected_argb32);
+
+    for(int i = 0; i < len + CANARY; i++)
+        dst[i] = CANARY_VALUE;
+    k->rgba_to_argb32(dst, rgba + 4 * first, len);
+    check_row(k->name, "rgba_to_argb32", dst, first, len, expected_argb32);
+
+    for(int i = 0; i < len + CANARY; i++)
+        dst[i] = CANARY_VALUE;
+    k->rgb_to_rgb24(dst, rgb + 3 * first, len);
+    check_row(k->name, "rgb_to_rgb24", dst, first, len, expected_rgb24);
+}
+
+int
+main(void)
+{
+    const char *names[] = { "scalar", "sse2", "avx2" };
+
+    for(int c = 0; c < 256; c++)
+        for(int a = 0; a < 256; a++)
+            if(draw_premultiply_channel(c, a) != c * a / 255)
+            {
+                fprintf(stderr, "draw_premultiply_channel(%d, %d) is wrong\n", c, a);
+                failures++;
+            }
+
+    for(size_t n = 0; n < sizeof(names) / sizeof(names[0]); n++)
+    {
+        const draw_kernels_t *k = draw_kernels_find(names[n]);
+        if(!k)
+        {
+            printf("%s: not supported, skipped\n", names[n]);
+            continue;
+        }
+
+        /* All pairs in one row, then short rows at unaligned positions */
+        check_kernels(k, 0, PIXELS);
+        for(int len = 0; len <= 67; len++)
+            for(int first = 0; first < 4; first++)
+                check_kernels(k, 1000 + first, len);
+        /* The last pixels, so that loads past the end of the row would be
+         * noticed by tools like valgrind */
+        for(int len = 1; len <= 67; len++)
+            check_kernels(k, PIXELS - len, len);
+
+        printf("%s: checked\n", names[n]);
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// vim: filetype=c:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,40 @@
+--- Check that redrawing a widget only copies its area to the screen.
+
+local runner = require("_runner")
+local wibox = require("wibox")
+
+local text = wibox.widget.textbox("a")
+text.forced_width = 50
+
+local wb = wibox {
+    x = 0, y = 0, width = 500, height = 50, visible = true,
+    widget = wibox.layout.fixed.horizontal(text, wibox.widget.textbox("static"))
+}
+
+local before
+
+local steps = {
+    -- Wait for the first complete repaint
+    function(count)
+        if count < 3 then
+            return
+        end
+        before = awesome.stats().drawables
+        text.text = "b"
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().drawables
+        local bytes = after.bytes - before.bytes
+        assert(after.copies > before.copies)
+        assert(bytes > 0)
+        assert(bytes <= 4 * 50 * wb.height, bytes)
+        assert(after.bytes_per_second >= 0)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,54 @@
+--- Check that _NET_CLIENT_LIST_STACKING is written at most once per refresh
+-- and not at all when the stacking order did not change.
+
+local runner = require("_runner")
+local test_client = require("_client")
+
+local c1, c2
+local before
+
+local steps = {
+    -- Spawn two clients
+    function(count)
+        if count == 1 then
+            test_client()
+            test_client()
+        end
+        if #client.get() >= 2 then
+            return true
+        end
+    end,
+
+    -- Restack them a few times in a row
+    function()
+        local stacked = client.get(nil, true)
+        c1, c2 = stacked[#stacked], stacked[1]
+        before = awesome.stats().ewmh
+        c1:raise()
+        c2:raise()
+        c1:raise()
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().ewmh
+        assert(after.updates == before.updates + 1, after.updates - before.updates)
+        before = after
+
+        -- End up with the same order again
+        c2:raise()
+        c1:raise()
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().ewmh
+        assert(after.updates == before.updates, after.updates - before.updates)
+        assert(after.skipped > before.skipped)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,105 @@
+--- Check that finding widgets by position gives the expected widgets, also
+-- after the layout changed.
+
+local runner = require("_runner")
+local wibox = require("wibox")
+
+local widgets = {}
+local layout = wibox.layout.fixed.horizontal()
+for i = 1, 20 do
+    widgets[i] = wibox.widget.textbox("entry " .. i)
+    widgets[i].forced_width = 50
+    layout:add(widgets[i])
+end
+
+local wb = wibox { x = 0, y = 0, width = 1000, height = 20, visible = true }
+wb:set_widget(layout)
+
+-- The widgets under a point, without the layout itself
+local function find(x, y)
+    local result = {}
+    for _, v in ipairs(wb:find_widgets(x, y)) do
+        if v.widget ~= layout then
+            table.insert(result, v.widget)
+        end
+    end
+    return result
+end
+
+-- Find the widgets by walking the whole hierarchy, like find_widgets did
+-- before it used a spatial index
+local function find_by_walk(x, y)
+    local result = {}
+    local function walk(h)
+        local x1, y1 = h:get_matrix_from_device():transform_point(x, y)
+        local x2, y2, w2, h2 = h:get_draw_extents()
+        if x1 < x2 or x1 >= x2 + w2 or y1 < y2 or y1 >= y2 + h2 then
+            return
+        end
+        local width, height = h:get_size()
+        if x1 >= 0 and y1 >= 0 and x1 <= width and y1 <= height then
+            table.insert(result, h:get_widget())
+        end
+        for _, child in ipairs(h:get_children()) do
+            walk(child)
+        end
+    end
+    walk(wb._drawable._widget_hierarchy)
+    return result
+end
+
+-- Check that the index finds the same widgets as the walk, also on and around
+-- the borders of the cells of the index
+local function compare_sweep()
+    for x = -2, 1002, 0.5 do
+        for _, y in ipairs{ 0, 10, 19.5, 20 } do
+            local expected = find_by_walk(x, y)
+            local actual = wb:find_widgets(x, y)
+            assert(#actual == #expected, x .. "," .. y)
+            for i, v in ipairs(actual) do
+                assert(v.widget == expected[i], x .. "," .. y)
+            end
+        end
+    end
+end
+
+local steps = {
+    function(count)
+        if count < 3 then
+            return
+        end
+        for i = 1, 20 do
+            local found = find((i - 1) * 50 + 25, 10)
+            assert(#found == 1 and found[1] == widgets[i], i)
+            assert(wb:find_widgets((i - 1) * 50 + 25, 10)[1].widget == layout)
+        end
+        -- The right edge of a widget is outside of its draw extents, so only
+        -- the next widget is hit
+        local found = find(49, 10)
+        assert(#found == 1 and found[1] == widgets[1])
+        found = find(50, 10)
+        assert(#found == 1 and found[1] == widgets[2])
+        compare_sweep()
+        -- Outside of the wibox, nothing is found
+        assert(#wb:find_widgets(-5, 10) == 0)
+
+        -- Change the layout
+        layout:remove(1)
+        return true
+    end,
+
+    function(count)
+        if count < 3 then
+            return
+        end
+        local found = find(25, 10)
+        assert(#found == 1 and found[1] == widgets[2])
+        assert(#find(975, 10) == 0)
+        compare_sweep()
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,65 @@
+--- Check that decoded images are cached and reloaded when their file changes.
+
+local runner = require("_runner")
+local surface = require("gears.surface")
+local cairo = require("lgi").cairo
+
+local path = os.tmpname()
+
+local function write_image(size)
+    local img = cairo.ImageSurface(cairo.Format.ARGB32, size, size)
+    local cr = cairo.Context(img)
+    cr:set_source_rgba(1, 0, 0, 0.5)
+    cr:paint()
+    img:write_to_png(path)
+end
+
+local function images()
+    return awesome.stats().images
+end
+
+local steps = {
+    function()
+        write_image(16)
+        local before = images()
+
+        -- Only the first load decodes the file
+        local a = surface.load_uncached(path)
+        local b = surface.load_uncached(path)
+        local after = images()
+        assert(after.misses == before.misses + 1, after.misses - before.misses)
+        assert(after.hits == before.hits + 1, after.hits - before.hits)
+        assert(after.count == before.count + 1)
+
+        -- Uncached loads still get their own image
+        assert(a ~= b)
+        assert(b.width == 16 and b.height == 16)
+
+        -- A changed file is decoded again
+        before = images()
+        write_image(32)
+        local d = surface.load_uncached(path)
+        after = images()
+        assert(d.width == 32, d.width)
+        assert(after.misses == before.misses + 1)
+        assert(after.count == before.count)
+
+        -- Purging empties the cache
+        awesome.purge_image_cache()
+        after = images()
+        assert(after.count == 0 and after.bytes == 0, after.count)
+
+        -- Without a budget, nothing is kept
+        awesome.set_image_cache_limit(0)
+        surface.load_uncached(path)
+        assert(images().count == 0)
+        awesome.set_image_cache_limit(32 * 1024 * 1024)
+
+        os.remove(path)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
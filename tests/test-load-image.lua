@@ -0,0 +1,96 @@
+--- Check that images loaded by awesome.load_image() get their alpha channel
+-- premultiplied exactly, for every combination of color and alpha values.
+
+local runner = require("_runner")
+local surface = require("gears.surface")
+local lgi = require("lgi")
+local GLib = lgi.GLib
+local GdkPixbuf = lgi.GdkPixbuf
+
+-- An odd width makes sure that the rows do not fit the vector kernels exactly
+local width, height = 259, 256
+
+local function source_pixel(x, y)
+    local c = x % 256
+    return c, 255 - c, (c * 7) % 256, y
+end
+
+local function premultiply(c, a)
+    return math.floor(c * a / 255)
+end
+
+-- What cairo's PNG writer does with premultiplied values
+local function unpremultiply(c, a)
+    if a == 0 then
+        return 0
+    end
+    return math.floor((c * 255 + math.floor(a / 2)) / a)
+end
+
+local function make_png(path, has_alpha)
+    local pixels = {}
+    for y = 0, height - 1 do
+        for x = 0, width - 1 do
+            local r, g, b, a = source_pixel(x, y)
+            if has_alpha then
+                table.insert(pixels, string.char(r, g, b, a))
+            else
+                table.insert(pixels, string.char(r, g, b))
+            end
+        end
+    end
+    local channels = has_alpha and 4 or 3
+    local pixbuf = GdkPixbuf.Pixbuf.new_from_bytes(GLib.Bytes(table.concat(pixels)),
+        GdkPixbuf.Colorspace.RGB, has_alpha, 8, width, height, width * channels)
+    assert(pixbuf:savev(path, "png", {}, {}))
+end
+
+-- Load an image with awesome and read it back through a PNG file
+local function load_and_read_back(path)
+    local surf = surface.load_uncached(path)
+    local out = path .. ".out.png"
+    surf:write_to_png(out)
+    local pixbuf = GdkPixbuf.Pixbuf.new_from_file(out)
+    os.remove(out)
+    return pixbuf
+end
+
+local function check(has_alpha)
+    local path = os.tmpname()
+    make_png(path, has_alpha)
+    local pixbuf = load_and_read_back(path)
+    os.remove(path)
+
+    assert(pixbuf.width == width and pixbuf.height == height)
+    assert(pixbuf.has_alpha == has_alpha)
+    local data = pixbuf:get_pixel_bytes().data
+    local channels = pixbuf.n_channels
+    for y = 0, height - 1 do
+        for x = 0, width - 1 do
+            local r, g, b, a = source_pixel(x, y)
+            local expected = { r, g, b }
+            if has_alpha then
+                for i = 1, 3 do
+                    expected[i] = unpremultiply(premultiply(expected[i], a), a)
+                end
+                expected[4] = a
+            end
+            local offset = y * pixbuf.rowstride + x * channels
+            for i, e in ipairs(expected) do
+                local got = data:byte(offset + i)
+                assert(got == e, string.format("pixel %d,%d channel %d: %d instead of %d",
+                    x, y, i, got, e))
+            end
+        end
+    end
+end
+
+runner.run_steps({
+    function()
+        check(true)
+        check(false)
+        return true
+    end,
+})
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,78 @@
+--- Check that menubar.utils.parse_dir only parses changed .desktop files again.
+
+local runner = require("_runner")
+local utils = require("menubar.utils")
+local gfs = require("gears.filesystem")
+
+local dir = os.tmpname()
+os.remove(dir)
+assert(gfs.mkdir(dir))
+local file = dir .. "/test.desktop"
+
+local function write_desktop_file(name)
+    local f = assert(io.open(file, "w"))
+    f:write("[Desktop Entry]\nType=Application\nName=" .. name .. "\nExec=true\n")
+    f:close()
+end
+
+local result, previous
+
+local function parse()
+    result = nil
+    utils.parse_dir(dir, function(programs)
+        result = programs
+    end)
+end
+
+local steps = {
+    function()
+        write_desktop_file("app")
+        parse()
+        return true
+    end,
+
+    function()
+        if not result then
+            return
+        end
+        assert(#result == 1 and result[1].Name == "app")
+        previous = result[1]
+        parse()
+        return true
+    end,
+
+    -- An unchanged file is not parsed again
+    function()
+        if not result then
+            return
+        end
+        assert(result[1] == previous)
+        write_desktop_file("changed app")
+        parse()
+        return true
+    end,
+
+    function()
+        if not result then
+            return
+        end
+        assert(#result == 1 and result[1].Name == "changed app", result[1].Name)
+        assert(result[1] ~= previous)
+        os.remove(file)
+        parse()
+        return true
+    end,
+
+    function()
+        if not result then
+            return
+        end
+        assert(#result == 0)
+        os.remove(dir)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
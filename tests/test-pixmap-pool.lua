@@ -0,0 +1,44 @@
+--- Check that resizing drawables recycles their pixmaps.
+
+local runner = require("_runner")
+local wibox = require("wibox")
+
+local w = wibox({ width = 97, height = 97, bg = "#ff0000" })
+local before
+
+local steps = {
+    function()
+        before = awesome.stats().pixmaps
+        -- All these sizes share a size class with the previous one
+        for i = 1, 5 do
+            w:geometry { width = 97 + i, height = 97 + i }
+        end
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().pixmaps
+        assert(after.hits == before.hits + 5, after.hits - before.hits)
+        assert(after.misses == before.misses, after.misses - before.misses)
+        before = after
+        return true
+    end,
+
+    -- Without a pool, unused pixmaps are freed right away
+    function()
+        awesome.set_pixmap_pool_limit(0)
+        local after = awesome.stats().pixmaps
+        assert(after.bytes == 0, after.bytes)
+        w.width = 300
+        after = awesome.stats().pixmaps
+        assert(after.bytes == 0, after.bytes)
+        assert(after.misses == before.misses + 1)
+        assert(after.evictions > before.evictions)
+        awesome.set_pixmap_pool_limit(16 * 1024 * 1024)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,33 @@
+--- Check that main loop wakeups without any changes do not touch any objects.
+
+local runner = require("_runner")
+
+local before
+
+local steps = {
+    function(count)
+        -- Give the default config some iterations to settle down
+        if count < 3 then
+            return
+        end
+        before = awesome.stats().refresh
+        return true
+    end,
+
+    function(count)
+        if count < 3 then
+            return
+        end
+        local after = awesome.stats().refresh
+        assert(after.count > before.count, "no refresh happened")
+        for _, kind in ipairs({ "drawins", "clients", "borders" }) do
+            assert(after[kind] == before[kind], string.format(
+                "idle refreshes touched %d %s", after[kind] - before[kind], kind))
+        end
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,59 @@
+--- Check that signals whose names have the same hash are kept apart.
+
+local runner = require("_runner")
+
+-- "Ez" and "FY" have the same djb2 hash, which is what signal names used to
+-- be identified by.
+local a, b = "test::Ez", "test::FY"
+
+local function check(connect, disconnect, emit)
+    local called = {}
+    local function on_a() table.insert(called, a) end
+    local function on_b() table.insert(called, b) end
+
+    connect(a, on_a)
+    connect(b, on_b)
+
+    emit(a)
+    assert(#called == 1 and called[1] == a, table.concat(called, ", "))
+
+    called = {}
+    emit(b)
+    assert(#called == 1 and called[1] == b, table.concat(called, ", "))
+
+    -- The same name built at runtime is still the same signal
+    called = {}
+    emit(table.concat({ "test::", "E", "z" }))
+    assert(#called == 1 and called[1] == a, table.concat(called, ", "))
+
+    disconnect(a, on_a)
+    disconnect(b, on_b)
+
+    called = {}
+    emit(a)
+    emit(b)
+    assert(#called == 0, table.concat(called, ", "))
+
+    -- Names that nobody connected to can be emitted and disconnected
+    for i = 1, 10 do
+        emit("test::never connected " .. i)
+        disconnect("test::never connected " .. i, on_a)
+    end
+    assert(#called == 0, table.concat(called, ", "))
+end
+
+runner.run_steps({
+    function()
+        check(awesome.connect_signal, awesome.disconnect_signal, awesome.emit_signal)
+        check(client.connect_signal, client.disconnect_signal, client.emit_signal)
+
+        local d = drawin({})
+        check(function(...) d:connect_signal(...) end,
+              function(...) d:disconnect_signal(...) end,
+              function(...) d:emit_signal(...) end)
+
+        return true
+    end,
+})
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,51 @@
+--- Check that restacking only sends requests for the windows that moved.
+
+local runner = require("_runner")
+local test_client = require("_client")
+
+local before
+
+local steps = {
+    -- Spawn some clients
+    function(count)
+        if count == 1 then
+            for _ = 1, 4 do
+                test_client()
+            end
+        end
+        if #client.get() >= 4 then
+            return true
+        end
+    end,
+
+    -- Raise the lowest one
+    function()
+        before = awesome.stats().stack
+        local stacked = client.get(nil, true)
+        stacked[#stacked]:raise()
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().stack
+        assert(after.count == before.count + 1, after.count - before.count)
+        assert(after.last_requests == 1, after.last_requests)
+        before = after
+        return true
+    end,
+
+    -- Without any changes, nothing is restacked
+    function(count)
+        if count < 3 then
+            return
+        end
+        local after = awesome.stats().stack
+        assert(after.count == before.count, after.count - before.count)
+        assert(after.requests == before.requests)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,77 @@
+--- Check that the tasklist only updates the entries that changed and reuses
+-- the widgets of closed clients.
+
+local runner = require("_runner")
+local test_client = require("_client")
+local awful = require("awful")
+
+local tasklist = awful.widget.tasklist(screen[1], awful.widget.tasklist.filter.alltags)
+
+local before, closed
+
+-- Get the textbox of a tasklist entry
+local function entry_textbox(bgb)
+    return bgb.widget:get_children()[2].widget
+end
+
+local steps = {
+    function(count)
+        if count == 1 then
+            for _ = 1, 3 do
+                test_client()
+            end
+        end
+        if #client.get() >= 3 and #tasklist:get_children() == 3 then
+            return true
+        end
+    end,
+
+    -- Renaming a client keeps all entries in place
+    function()
+        before = tasklist:get_children()
+        client.get()[2].name = "renamed client"
+        return true
+    end,
+
+    function(count)
+        if not entry_textbox(before[2]).markup:find("renamed client", 1, true) then
+            assert(count < 5)
+            return
+        end
+        assert(tasklist:get_children() == before)
+        for i = 1, 3 do
+            assert(tasklist:get_children()[i] == before[i])
+        end
+        return true
+    end,
+
+    -- The entry of a closed client goes to a new client
+    function()
+        local clients = client.get()
+        closed = before[3]
+        clients[3]:kill()
+        return true
+    end,
+
+    function(count)
+        if count == 1 then
+            return
+        end
+        if #client.get() == 2 and #tasklist:get_children() == 2 then
+            test_client()
+            return true
+        end
+    end,
+
+    function()
+        if #client.get() < 3 or #tasklist:get_children() < 3 then
+            return
+        end
+        assert(tasklist:get_children()[3] == closed)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -0,0 +1,54 @@
+--- Check that changing the wallpaper of a screen repaints it in place.
+
+local runner = require("_runner")
+local wp = require("gears.wallpaper")
+local cairo = require("lgi").cairo
+
+local img = cairo.ImageSurface.create(cairo.Format.ARGB32, 100, 100)
+
+local before
+
+local steps = {
+    -- Make sure the current wallpaper was set by us
+    function()
+        wp.set("#000030")
+        return true
+    end,
+
+    function()
+        before = awesome.stats().wallpaper
+        wp.maximized(img, screen[1])
+        return true
+    end,
+
+    -- Only the screen was repainted, into the same pixmap
+    function()
+        local after = awesome.stats().wallpaper
+        local geo = screen[1].geometry
+        assert(after.count == before.count + 1, after.count - before.count)
+        assert(after.full == before.full, after.full - before.full)
+        assert(after.pixels - before.pixels == geo.width * geo.height,
+            after.pixels - before.pixels)
+        before = after
+        return true
+    end,
+
+    -- Several screens are combined into a single update
+    function()
+        for s in screen do
+            wp.centered(img, s, "#00ff00")
+        end
+        return true
+    end,
+
+    function()
+        local after = awesome.stats().wallpaper
+        assert(after.count == before.count + 1, after.count - before.count)
+        assert(after.full == before.full, after.full - before.full)
+        return true
+    end,
+}
+
+runner.run_steps(steps)
+
+-- vim: filetype=lua:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:textwidth=80
@@ -319,14 +319,14 @@ event_handle_xkb_notify(xcb_generic_event_t* event)
 
           if (new_keyboard_event->changed & XCB_XKB_NKN_DETAIL_KEYCODES)
           {
-              signal_object_emit(L, &global_signals, "xkb::map_changed", 0);
+              signal_object_emit(L, &global_signals, SIGNAL_ID("xkb::map_changed"), 0);
           }
           break;
         }
       case XCB_XKB_MAP_NOTIFY:
         {
           xkb_reload_keymap();
-          signal_object_emit(L, &global_signals, "xkb::map_changed", 0);
+          signal_object_emit(L, &global_signals, SIGNAL_ID("xkb::map_changed"), 0);
           break;
         }
       case XCB_XKB_STATE_NOTIFY:
@@ -344,7 +344,7 @@ event_handle_xkb_notify(xcb_generic_event_t* event)
           if (state_notify_event->changed & XCB_XKB_STATE_PART_GROUP_STATE)
           {
               lua_pushinteger(L, state_notify_event->group);
-              signal_object_emit(L, &global_signals, "xkb::group_changed", 1);
+              signal_object_emit(L, &global_signals, SIGNAL_ID("xkb::group_changed"), 1);
           }
 
           break;